@@ -0,0 +1,207 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+#include "global_args.h"
+#include "ClusterList.h"
+#include "DBSCAN.h"
+#include "NodePool.h"
+
+// Globals (DBSCAN reads epsilon)
+ImpaqtArguments::GlobalArgs ImpaqtArguments::Args;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* DBSCAN Benchmark
+	One synthetic node of `points` 5' ends: `peaks` tight peaks plus `noise`
+	points scattered across the locus, clustered on its 5' ends by:
+	  - alloc:   the previous kernel, a new queued vector per seed point and a
+	             new neighbor vector per search
+	  - scratch: dbscan() with --dbscan-kernel scan, per-thread buffers and epoch marks
+	  - linear:  dbscan() with the default kernel, one sliding window over the sorted points,
+	             on one thread and then split across `threads`
+	Noise points are seeds that never become core points, so each one cost
+	the previous kernel a points-sized allocation. Dense peaks cost the scan
+	kernels a neighbor search per distinct offset; the linear kernel touches
+	each point a fixed number of times.
+
+	usage: dbscan_bench [points] [noise] [peaks] [threads]
+*/
+
+static const int locus = 60000;
+
+// Previous neighbor search (returns a new vector, marks a vector<bool> if given)
+template <typename T>
+static std::vector<int> alloc_neighbors(const int &i, const int &points, std::vector<bool> &queued,
+                                        const std::vector<T> &sorted, const std::vector<int> &sorted_weights,
+                                        int &weight) {
+	int bound;
+	std::vector<int> neighbors;
+	weight = sorted_weights[i] - 1;
+	bound = (int)sorted[i] + ImpaqtArguments::Args.epsilon;
+	for (int j = i + 1; j < points; j++) {
+		if ((int)sorted[j] > bound) { break; }
+		if (!queued.empty()) { queued[j] = true; }
+		neighbors.push_back(j);
+		weight += sorted_weights[j];
+	}
+	bound = (int)sorted[i] - ImpaqtArguments::Args.epsilon;
+	for (int j = i - 1; j >= 0; j--) {
+		if ((int)sorted[j] < bound) { break; }
+		if (!queued.empty()) { queued[j] = true; }
+		neighbors.push_back(j);
+		weight += sorted_weights[j];
+	}
+	return neighbors;
+}
+
+// Previous kernel, as dbscan_offsets was before its scratch buffers
+template <typename T>
+static std::vector<int> alloc_dbscan(const T *adj, const std::vector<int> &weights, const int &base,
+                                     const int &points, const int &min_counts, std::map<int, std::vector<int>> &regions) {
+
+	bool skip;
+	int clust_num = 0;
+	int p1, p2, index, weight, sub_weight;
+	std::vector<bool> empty_vec;
+	std::vector<int> neighbors, sub_neighbors;
+	std::vector<int> indices(points);
+	std::vector<int> assign_vec(points, -1);
+	std::vector<bool> visted(points, false);
+
+	std::iota(indices.begin(), indices.end(), 0);
+	std::sort(indices.begin(), indices.end(), [&](int i, int j) -> bool { return adj[2 * i] < adj[2 * j]; });
+	std::vector<T> sorted(points);
+	std::vector<int> sorted_weights(points, 1);
+	for (int i = 0; i < points; i++) {
+		sorted[i] = adj[2 * indices[i]];
+		if (!weights.empty()) { sorted_weights[i] = weights[indices[i]]; }
+	}
+
+	for (int i = 0; i < points; i++) {
+		if (visted[i] == true) { continue; }
+		p1 = indices[i];
+		std::vector<bool> queued(points, false);
+		neighbors = alloc_neighbors(i, points, queued, sorted, sorted_weights, weight);
+		if (weight >= min_counts) {
+			visted[i] = true;
+			assign_vec.at(p1) = clust_num;
+			std::vector<int> cluster_points = {(int)sorted[i]};
+			int x = 0;
+			while (x < (int)neighbors.size()) {
+				index = neighbors[x];
+				p2 = indices[index];
+				if (visted[index] == false) {
+					skip = false;
+					for (const auto &t_point : cluster_points) {
+						if ((int)sorted[index] == t_point) {
+							assign_vec.at(p2) = clust_num;
+							visted[index] = true;
+							skip = true;
+							break;
+						}
+					}
+					if (!skip) {
+						visted[index] = true;
+						assign_vec.at(p2) = clust_num;
+						sub_neighbors = alloc_neighbors(index, points, empty_vec, sorted, sorted_weights, sub_weight);
+						if (sub_weight >= min_counts) {
+							for (const auto &n : sub_neighbors) {
+								if (!queued[n]) {
+									neighbors.push_back(n);
+									queued[n] = true;
+								}
+							}
+							cluster_points.push_back((int)sorted[index]);
+						}
+					}
+				}
+				++x;
+			}
+			const int min_point = *std::min_element(cluster_points.begin(), cluster_points.end());
+			const int max_point = *std::max_element(cluster_points.begin(), cluster_points.end());
+			regions[clust_num] = std::vector<int>{base + min_point, base + max_point};
+			clust_num += 1;
+			i = x - 1;
+		}
+	}
+	return assign_vec;
+}
+
+int main(int argc, char const ** argv) {
+
+	const int points = (argc > 1) ? std::stoi(argv[1]) : 1000000;
+	const int noise = (argc > 2) ? std::stoi(argv[2]) : 5000;
+	const int peaks = (argc > 3) ? std::stoi(argv[3]) : 40;
+	const int threads = (argc > 4) ? std::stoi(argv[4]) : 4;
+	ImpaqtArguments::Args.epsilon = 50;
+
+	// One node, one stored read holding every point (so nothing folds)
+	std::mt19937 rng(7);
+	std::normal_distribution<double> spread(0.0, 10.0);
+	std::uniform_int_distribution<int> anywhere(0, locus);
+	ClusterNode node(0, 0, locus, 0);
+	for (int i = 0; i < points; i++) {
+		int five;
+		if (i < noise) {
+			five = anywhere(rng);
+		} else {
+			const int peak = (i % peaks) * (locus / peaks) + locus / (2 * peaks);
+			five = std::max(0, peak + (int)spread(rng));
+		}
+		node.add_block(five, five + 100);
+	}
+	node.close_read();
+	const int min_counts = std::max(points / 100, 10);
+
+	// Alloc
+	std::map<int, std::vector<int>> alloc_regions;
+	auto start = std::chrono::steady_clock::now();
+	const std::vector<int> alloc_assign = node.visit_points([&](const auto *pairs) {
+		return alloc_dbscan(pairs, std::vector<int>(), node.get_point_base(), points, min_counts, alloc_regions);
+	});
+	const double t_alloc = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Scratch (twice: the second call reuses the first call's buffers)
+	std::map<int, std::vector<int>> regions, warm_regions, linear_regions;
+	ImpaqtArguments::Args.dbscan_kernel = "scan";
+	start = std::chrono::steady_clock::now();
+	const std::vector<int> assign = dbscan(&node, points, min_counts, regions, true);
+	const double t_scratch = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	const std::vector<int> warm_assign = dbscan(&node, points, min_counts, warm_regions, true);
+	const double t_warm = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Linear (buffers already warm)
+	ImpaqtArguments::Args.dbscan_kernel = "linear";
+	start = std::chrono::steady_clock::now();
+	const std::vector<int> linear_assign = dbscan(&node, points, min_counts, linear_regions, true);
+	const double t_linear = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Linear, split across threads (chunks are pool tasks)
+	std::map<int, std::vector<int>> parallel_regions;
+	ImpaqtArguments::Args.threads = threads;
+	NodePool::start(threads - 1, 1);
+	start = std::chrono::steady_clock::now();
+	const std::vector<int> parallel_assign = dbscan(&node, points, min_counts, parallel_regions, true);
+	const double t_parallel = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	NodePool::stop();
+
+	const bool match = (assign == alloc_assign && regions == alloc_regions && warm_assign == assign && warm_regions == regions &&
+	                    linear_assign == assign && linear_regions == regions &&
+	                    parallel_assign == assign && parallel_regions == regions);
+
+	std::cout << "//node\t" << points << " points (" << noise << " noise, " << peaks << " peaks, " << regions.size() << " clusters)\n"
+	          << "//alloc_ms\t" << t_alloc << "\n"
+	          << "//scratch_ms\t" << t_scratch << "\n"
+	          << "//scratch_warm_ms\t" << t_warm << "\n"
+	          << "//linear_ms\t" << t_linear << "\n"
+	          << "//linear_" << threads << "_threads_ms\t" << t_parallel << "\n"
+	          << "//clusters_match\t" << (match ? "yes" : "NO") << "\n";
+
+	return match ? 0 : 1;
+}
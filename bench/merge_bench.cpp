@@ -0,0 +1,90 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "global_args.h"
+#include "ClusterNode.h"
+
+// Globals (ClusterNode only reads them when writing GTF)
+ImpaqtArguments::GlobalArgs ImpaqtArguments::Args;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Node Merge Benchmark
+	Cost of collapsing one long, densely covered locus window by window:
+	  - copy:    every merge builds a new node from copies of both (previous merge_nodes)
+	  - absorb:  ClusterNode::absorb appends the neighbour onto the surviving node
+	Each window holds `reads` two-block reads, so the locus ends with windows * reads * 2 points.
+
+	usage: merge_bench [windows] [reads]
+*/
+
+static const int window_size = 1000;
+
+// Window w of the locus, filled the way create_clusters would
+static ClusterNode make_window(const int &w, const int &reads) {
+	ClusterNode node(w * window_size, 0, window_size, 0);
+	for (int r = 0; r < reads; r++) {
+		const int five = w * window_size + r;
+		node.add_block(five, five + 100);
+		node.add_block(five + 400, five + 500);
+		node.add_junction(five + 101);
+		node.close_read();
+	}
+	node.shrink_vectors();
+	return node;
+}
+
+// Previous merge: a new node holding copies of both (same result as absorb, paid in full every time)
+static ClusterNode copy_merge(const ClusterNode &c_node, const ClusterNode &n_node) {
+	ClusterNode merged = c_node;
+	ClusterNode neighbour = n_node;
+	merged.absorb(neighbour);
+	return merged;
+}
+
+// Same points, reads and junctions
+static bool same_node(const ClusterNode &a, const ClusterNode &b) {
+	const PointStore &p = a.get_points(), &q = b.get_points();
+	if (p.size() != q.size() || p.reads() != q.reads()) { return false; }
+	for (size_t i = 0; i < p.size(); i++) {
+		if (p.five(i) != q.five(i) || p.three(i) != q.three(i)) { return false; }
+	}
+	for (size_t r = 0; r < p.reads(); r++) {
+		if (p.read_end(r) != q.read_end(r) || p.read_weight(r) != q.read_weight(r)) { return false; }
+	}
+	return a.get_junctions() == b.get_junctions() && a.get_read_count() == b.get_read_count();
+}
+
+int main(int argc, char const ** argv) {
+
+	const int windows = (argc > 1) ? std::stoi(argv[1]) : 2000;
+	const int reads = (argc > 2) ? std::stoi(argv[2]) : 50;
+
+	std::vector<ClusterNode> locus;
+	for (int w = 0; w < windows; w++) { locus.push_back(make_window(w, reads)); }
+
+	// Copy
+	std::vector<ClusterNode> nodes = locus;
+	auto start = std::chrono::steady_clock::now();
+	ClusterNode copied = nodes[0];
+	for (int w = 1; w < windows; w++) { copied = copy_merge(copied, nodes[w]); }
+	const double t_copy = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Absorb
+	nodes = locus;
+	start = std::chrono::steady_clock::now();
+	ClusterNode &absorbed = nodes[0];
+	for (int w = 1; w < windows; w++) { absorbed.absorb(nodes[w]); }
+	absorbed.shrink_vectors();
+	const double t_absorb = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	const bool match = same_node(copied, absorbed);
+
+	std::cout << "//locus\t" << windows << " windows x " << reads << " reads (" << absorbed.get_vec_count() << " points)\n"
+	          << "//copy_ms\t" << t_copy << "\n"
+	          << "//absorb_ms\t" << t_absorb << "\n"
+	          << "//nodes_match\t" << (match ? "yes" : "NO") << "\n";
+
+	return match ? 0 : 1;
+}
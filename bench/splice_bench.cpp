@@ -0,0 +1,76 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "global_args.h"
+#include "AlignmentReader.h"
+#include "ClusterList.h"
+
+// Globals (defaults only matter for the list constructor)
+ImpaqtArguments::GlobalArgs ImpaqtArguments::Args;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Splice Extraction Benchmark
+	Per-read cost of turning a CIGAR into node points:
+	  - vectors:  calculate_splice into positions/junctions, then ClusterNode::add_alignment
+	  - direct:   ClusterList::add_splice straight into the node
+	Records are decoded once up front, so only the extraction is timed.
+
+	usage: splice_bench [file.bam] [rounds]   (run from the build directory)
+*/
+
+int main(int argc, char const ** argv) {
+
+	const std::string file_name = (argc > 1) ? argv[1] : "../test/data/SpliceTest.bam";
+	const int rounds = (argc > 2) ? std::stoi(argv[2]) : 20000;
+
+	AlignmentReader in_file;
+	if (!in_file.open(file_name)) {
+		std::cerr << "ERROR: Could not read alignment file: " << file_name << "\n";
+		return 1;
+	}
+
+	std::vector<AlignmentRecord> records;
+	AlignmentRecord alignment;
+	while (in_file.get_next_alignment(alignment)) { records.push_back(alignment); }
+	in_file.close();
+	if (records.empty()) { std::cerr << "ERROR: No alignments in " << file_name << "\n"; return 1; }
+
+	ClusterList cluster_list;
+	const double reads = (double)records.size() * rounds;
+	size_t check_vectors = 0, check_direct = 0;
+
+	// Vectors (previous create_clusters path)
+	auto start = std::chrono::steady_clock::now();
+	{
+		std::vector<int> positions, junctions;
+		for (int r = 0; r < rounds; r++) {
+			ClusterNode node(0, 0, 1000, 0);
+			for (const auto &record : records) {
+				positions.clear();
+				junctions.clear();
+				cluster_list.calculate_splice(record, positions, junctions);
+				node.add_alignment(positions, junctions);
+			}
+			check_vectors += node.get_vec_count();
+		}
+	}
+	const double t_vectors = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	// Direct
+	start = std::chrono::steady_clock::now();
+	for (int r = 0; r < rounds; r++) {
+		ClusterNode node(0, 0, 1000, 0);
+		for (const auto &record : records) { cluster_list.add_splice(&node, record); }
+		check_direct += node.get_vec_count();
+	}
+	const double t_direct = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "//reads\t" << records.size() << " x " << rounds << "\n"
+	          << "//vectors_ns_per_read\t" << t_vectors / reads << "\n"
+	          << "//direct_ns_per_read\t" << t_direct / reads << "\n"
+	          << "//points_match\t" << (check_vectors == check_direct ? "yes" : "NO") << "\n";
+
+	return (check_vectors == check_direct) ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <ostream>
+#include <cstdint>
+
+#ifdef IMPAQT_USE_HTSLIB
+#include <htslib/sam.h>
+#include <htslib/thread_pool.h>
+#else
+#include <api/BamAux.h>
+#include <api/BamReader.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Alignment Record (only the fields clustering needs, independent of the decoding backend) */
+
+struct CigarEntry {
+	char type;
+	int length;
+};
+
+struct AlignmentRecord {
+
+	int ref_id = -1;
+	int position = -1;
+	uint16_t flag = 0;
+	uint8_t mapq = 0;
+	int nh = 1;                          // NH tag (1 if absent)
+	std::vector<CigarEntry> cigar;       // reused between records, so no per-read allocation
+
+	bool is_paired() const { return flag & 0x1; }
+	bool is_mapped() const { return !(flag & 0x4); }
+	bool is_reverse_strand() const { return flag & 0x10; }
+	bool is_primary_alignment() const { return !(flag & 0x100); }
+	bool is_duplicate() const { return flag & 0x400; }
+};
+
+// Reference sequence from the alignment header
+struct ContigInfo {
+	std::string name;
+	int length;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Alignment Ring
+	Bounded single-producer/single-consumer ring of decoded records between a
+	decoder thread and the clustering thread. Lock-free while records flow: each
+	side owns one index and only reads the other's. A side that finds the ring
+	full (or empty) spins briefly, then parks on a condition variable until the
+	other side moves; the other side only takes the lock when someone is parked.
+	Slots (and their CIGAR vectors) are reused.
+*/
+
+class AlignmentRing {
+
+private:
+
+	static const int spin_limit = 64;          // yields before parking
+
+	std::vector<AlignmentRecord> slots;
+	size_t mask;
+	alignas(64) std::atomic<size_t> head{0};   // next slot to fill (decoder)
+	alignas(64) std::atomic<size_t> tail{0};   // next slot to read (clustering)
+	std::atomic<bool> done{false};             // decoder hit the end
+	std::atomic<bool> stop{false};             // clustering no longer wants records
+
+	// Parking (a side sets its flag under park_lock before sleeping)
+	std::mutex park_lock;
+	std::condition_variable park_cv;
+	std::atomic<bool> decoder_parked{false};
+	std::atomic<bool> consumer_parked{false};
+
+	bool is_full(const size_t &h) const { return h - tail.load(std::memory_order_acquire) == slots.size(); }
+	bool is_empty(const size_t &t) const { return head.load(std::memory_order_acquire) == t; }
+
+	// Spin, then sleep, until ready() holds
+	template <typename Ready>
+	void wait_for(std::atomic<bool> &parked, Ready ready) {
+		for (int i = 0; i < spin_limit; i++) {
+			if (ready()) { return; }
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock(park_lock);
+		parked.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in wake
+		park_cv.wait(lock, ready);
+		parked.store(false, std::memory_order_relaxed);
+	}
+
+	// After moving an index: wake the other side if it is parked
+	void wake(std::atomic<bool> &parked) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!parked.load(std::memory_order_relaxed)) { return; }
+		{ std::unique_lock<std::mutex> lock(park_lock); }
+		park_cv.notify_all();
+	}
+
+	void wake_all() {
+		{ std::unique_lock<std::mutex> lock(park_lock); }
+		park_cv.notify_all();
+	}
+
+public:
+
+	// Occupancy (each only touched by one side)
+	size_t pops = 0;                           // records taken by clustering
+	size_t fill_sum = 0;                       // records waiting, summed over pops
+	size_t empty_waits = 0;                    // clustering found nothing (decoder is the bottleneck)
+	size_t full_waits = 0;                     // decoder found no room (clustering is the bottleneck)
+
+	// Capacity rounded up to a power of two
+	AlignmentRing(const size_t &capacity) {
+		size_t n = 2;
+		while (n < capacity) { n <<= 1; }
+		slots.resize(n);
+		mask = n - 1;
+	}
+
+	size_t capacity() const { return slots.size(); }
+
+	// Decoder: free slot to fill, nullptr once the consumer has stopped
+	AlignmentRecord* fill_slot() {
+		const size_t h = head.load(std::memory_order_relaxed);
+		if (is_full(h)) {
+			++full_waits;
+			wait_for(decoder_parked, [&] { return !is_full(h) || stop.load(std::memory_order_acquire); });
+		}
+		return stop.load(std::memory_order_acquire) ? nullptr : &slots[h & mask];
+	}
+	void publish() {
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		wake(consumer_parked);
+	}
+	void finish() {
+		done.store(true, std::memory_order_release);
+		wake_all();
+	}
+
+	// Consumer: oldest filled slot, nullptr once the decoder is done and the ring is drained
+	AlignmentRecord* read_slot() {
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if (is_empty(t)) {
+			++empty_waits;
+			wait_for(consumer_parked, [&] { return !is_empty(t) || done.load(std::memory_order_acquire); });
+		}
+		const size_t h = head.load(std::memory_order_acquire); // last publish lands before done
+		if (h == t) { return nullptr; }
+		++pops;
+		fill_sum += h - t;
+		return &slots[t & mask];
+	}
+	void release() {
+		tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		wake(decoder_parked);
+	}
+	void cancel() {
+		stop.store(true, std::memory_order_release);
+		wake_all();
+	}
+};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Alignment Reader Class
+	Thin wrapper so ClusterList does not care which library decodes the BAM.
+	  - default:            bamtools (BGZF inflated on the calling thread)
+	  - IMPAQT_USE_HTSLIB:  htslib, with BGZF inflation spread over a thread pool
+	                        shared by every open reader (see init_thread_pool)
+*/
+
+class AlignmentReader {
+
+private:
+
+	std::string file_name;
+	std::string sort_order;
+	std::vector<ContigInfo> references;
+
+#ifdef IMPAQT_USE_HTSLIB
+	samFile *in_file = nullptr;
+	sam_hdr_t *header = nullptr;
+	hts_idx_t *index = nullptr;
+	hts_itr_t *iter = nullptr;
+	bam1_t *record = nullptr;
+
+	static hts_tpool *decode_pool;
+	static htsThreadPool shared_pool;
+#else
+	BamTools::BamReader in_file;
+	BamTools::BamAlignment record;
+	bool char_data = false;              // record has name/bases/qualities/tags built
+#endif
+
+	bool held = false;                   // hand the current record out again (see hold)
+
+	// Pipelined decoding (see start_pipeline)
+	std::unique_ptr<AlignmentRing> ring;
+	AlignmentRecord *ring_record = nullptr;  // slot handed out last, released on the next read
+	bool ring_held = false;                  // hold() while pipelined (held belongs to the decoder then)
+	std::thread decoder;
+
+	// Run-wide ring occupancy, summed as pipelines stop
+	static std::atomic<size_t> total_pops;
+	static std::atomic<size_t> total_fill;
+	static std::atomic<size_t> total_empty_waits;
+	static std::atomic<size_t> total_full_waits;
+	static std::atomic<size_t> ring_capacity;
+
+	void read_header();
+
+	// Backend decoding (the public versions read from the ring instead when pipelined)
+	bool decode_core(AlignmentRecord &alignment);
+	void decode_nh(AlignmentRecord &alignment);
+	void decode_cigar(AlignmentRecord &alignment);
+	bool next_from_ring(AlignmentRecord &alignment);
+
+public:
+
+	/////////////////////////////////////////////////////////////
+	/* Constructors */
+
+	AlignmentReader() {}
+	~AlignmentReader() { this -> close(); }
+
+	// One open file per reader
+	AlignmentReader(const AlignmentReader&) = delete;
+	AlignmentReader& operator=(const AlignmentReader&) = delete;
+
+	/////////////////////////////////////////////////////////////
+	/* Get Functions */
+
+	bool has_sort_order() const { return !sort_order.empty(); }
+	const std::string& get_sort_order() const { return sort_order; }
+	const std::vector<ContigInfo>& get_references() const { return references; }
+
+	/////////////////////////////////////////////////////////////
+	/* File Functions */
+
+	bool open(const std::string &t_file_name);
+	bool open_index(const std::string &index_name);
+	bool jump(const int &contig_index, const int &position = 0);
+	void close();
+
+	// Fill alignment with the next record, false at end of file (or region)
+	bool get_next_alignment(AlignmentRecord &alignment);
+
+	// Lean path: only the fixed-width core (ref_id, position, flag, mapq) is filled,
+	// NH and the CIGAR are decoded on request for the same record
+	// (pipelined records arrive fully decoded, so the loads are no-ops)
+	bool get_next_core(AlignmentRecord &alignment);
+	void load_nh(AlignmentRecord &alignment) { if (ring == nullptr) { this -> decode_nh(alignment); } }
+	void load_cigar(AlignmentRecord &alignment) { if (ring == nullptr) { this -> decode_cigar(alignment); } }
+
+	// Push the current record back, so the next get_next_core returns it again
+	//	(a contig's reader stops on the first record of the next contig)
+	void hold() { if (ring != nullptr) { ring_held = true; } else { held = true; } }
+
+	/////////////////////////////////////////////////////////////
+	/* Pipelined Decoding
+		A decoder thread reads ahead into a ring of `capacity` records while the
+		caller clusters. With contig_index set, it stops after the first record
+		past that contig. Once stopped the file position is ahead of the caller,
+		so only close or jump afterwards.
+	*/
+
+	void start_pipeline(const int &capacity, const int &contig_index = -1);
+	void stop_pipeline();
+	static void print_pipeline_stats(std::ostream &out);
+
+	/////////////////////////////////////////////////////////////
+	/* Decompression Thread Pool (no-ops for bamtools) */
+
+	static void init_thread_pool(const int &threads);
+	static void destroy_thread_pool();
+};
@@ -18,9 +18,9 @@ private:
 	std::string stranded;
 	bool isGFF;
 
-	// Get First Feature of Chrom
-	std::unordered_map<std::string, GeneNode*> pos_chrom_map;
-	std::unordered_map<std::string, GeneNode*> neg_chrom_map;
+	// First gene of each alignment contig (by RefID, see set_contig_ids)
+	std::vector<GeneNode*> pos_contig_heads;
+	std::vector<GeneNode*> neg_contig_heads;
 
 	int features = 0;
 	std::string feature_id;
@@ -99,11 +99,10 @@ public:
 		return neg_tail;
 	}
 
-	GeneNode* jump_to_chrom(const std::string t_chrom, const int t_strand) const {
-		const std::unordered_map<std::string, GeneNode*> &chrom_map = (t_strand == 0) ? pos_chrom_map : neg_chrom_map;
-		auto it = chrom_map.find(t_chrom);
-		if (it == chrom_map.end()) { return nullptr; }
-		return it -> second;
+	GeneNode* jump_to_contig(const int t_contig_id, const int t_strand) const {
+		const std::vector<GeneNode*> &contig_heads = (t_strand == 0) ? pos_contig_heads : neg_contig_heads;
+		if (t_contig_id < 0 || t_contig_id >= (int)contig_heads.size()) { return nullptr; }
+		return contig_heads[t_contig_id];
 	}
 
 	// Get first gene by position (just trust me on this one)
@@ -146,6 +145,9 @@ public:
 	// Create Gene Graph Structure
 	void create_gene_list();
 
+	// Tag genes with the RefID of their chromosome, once, so contig checks are integer compares
+	void set_contig_ids(const std::unordered_map<int, std::string> &contig_map);
+
 	/////////////////////////////////////////////////////////////
 	/* Output Functions */
 
@@ -195,17 +197,4 @@ public:
 			c_node = c_node -> get_next();
 		}
 	}
-
-	// Print genes and counts
-	void print_chrom_map() {
-		std::cerr << "// Positive Strand Chrom Map\n";
-		for (const auto &pair : pos_chrom_map) {
-			std::cerr << pair.first << ": " << pair.second << "\n";
-		}
-
-		std::cerr << "// Negative Strand Chrom Map\n";
-		for (const auto &pair : neg_chrom_map) {
-			std::cerr << pair.first << ": " << pair.second << "\n";
-		}
-	}
 };
\ No newline at end of file
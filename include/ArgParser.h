@@ -58,9 +58,26 @@ inline void print_usage() {
         "Identifies and quantifies isoforms utilizing distinct 3' ends. Generates a GTF\n"
         "file of identified transcripts and optionally a counts file to stdout if a\n"
         "reference annotation is provided.\n\n"
-        "Usage: impaqt input.sorted.bam [options]\n\n"
+        "Usage: impaqt input.sorted.bam [options]\n"
+        "       aligner ... | samtools sort ... | impaqt - -o out.gtf [options]\n\n"
         "Options:\n"
         "  -t, --threads INT             Number of processers for multithreading. [1]\n"
+        "  -b, --bgzf-threads INT        Extra threads for BGZF decompression, shared by all\n"
+        "                                contigs. Requires an htslib build. [0]\n"
+        "      --tile-size INT           Split contigs longer than this (bp) into tiles\n"
+        "                                clustered in parallel. 0 disables. [10000000]\n"
+        "      --stream                  Read the BAM once from start to end instead of jumping\n"
+        "                                to each contig. No index needed; disables tiling.\n"
+        "                                Always on for \"-\" (stdin) and pipes.\n"
+        "      --ring-size INT           Decode alignments on their own thread, INT records\n"
+        "                                ahead of clustering. Reports ring occupancy. 0 = off. [0]\n"
+        "      --readahead               Have the kernel read each contig (or tile) into the\n"
+        "                                page cache before it is decoded. Ignored for pipes.\n"
+        "      --max-memory INT          MB of read points to buffer across all contigs; past\n"
+        "                                this, finished clusters spill to $TMPDIR. 0 = off. [0]\n"
+        "      --windowed                Cluster, assign and write each locus as soon as the reads\n"
+        "                                have moved past it, so memory follows the widest locus\n"
+        "                                rather than the longest contig. Disables tiling.\n"
         "  -a, --annotation FILE         Annotation file (GTF or GFF). If set, a counts\n"
         "                                table is written to stdout. Type from extension. []\n"
         "  -s, --strandedness STR        Strandedness of library: forward or reverse. [forward]\n"
@@ -71,6 +88,9 @@ inline void print_usage() {
         "  -p, --count-percentage INT    Min read count percentage for core reads in DBSCAN. [5]\n"
         "  -e, --epsilon INT             Neighbor distance (bp) for DBSCAN. [50]\n"
         "  -d, --density-threshold DBL   Read density (#reads/#bp) to skip identification. [0]\n"
+        "                                Unskipped deep loci are clustered on spare --threads.\n"
+        "      --dbscan-kernel STR       DBSCAN engine: linear, or scan (per-point neighbor\n"
+        "                                scans, same clusters; for validation). [linear]\n"
         "  -f, --feature-tag STR         Name of feature in GTF for assignment. [exon]\n"
         "  -u, --utr-tag STR             Name of UTR feature in GTF for assignment. [UTR]\n"
         "  -i, --feature-id STR          ID of feature to use for assignment. [gene_id]\n"
@@ -87,6 +107,13 @@ inline ParseStatus argparse(int argc, char const **argv) {
 
     // Defaults (formerly seqan setDefaultValue)
     ImpaqtArguments::Args.threads = 1;
+    ImpaqtArguments::Args.bgzf_threads = 0;
+    ImpaqtArguments::Args.tile_size = 10000000;
+    ImpaqtArguments::Args.stream = false;
+    ImpaqtArguments::Args.ring_size = 0;
+    ImpaqtArguments::Args.readahead = false;
+    ImpaqtArguments::Args.max_memory = 0;
+    ImpaqtArguments::Args.windowed = false;
     ImpaqtArguments::Args.annotation_file = "";
     ImpaqtArguments::Args.stranded = "forward";
     ImpaqtArguments::Args.nonunique_alignments = false;
@@ -96,6 +123,7 @@ inline ParseStatus argparse(int argc, char const **argv) {
     ImpaqtArguments::Args.count_percentage = 5;
     ImpaqtArguments::Args.epsilon = 50;
     ImpaqtArguments::Args.density_threshold = 0;
+    ImpaqtArguments::Args.dbscan_kernel = "linear";
     ImpaqtArguments::Args.feature_tag = "exon";
     ImpaqtArguments::Args.utr_tag = "UTR";
     ImpaqtArguments::Args.feature_id = "gene_id";
@@ -117,9 +145,21 @@ inline ParseStatus argparse(int argc, char const **argv) {
             ImpaqtArguments::Args.nonunique_alignments = true;
             continue;
         }
+        if (tok == "--stream") {
+            ImpaqtArguments::Args.stream = true;
+            continue;
+        }
+        if (tok == "--readahead") {
+            ImpaqtArguments::Args.readahead = true;
+            continue;
+        }
+        if (tok == "--windowed") {
+            ImpaqtArguments::Args.windowed = true;
+            continue;
+        }
 
-        // Positional argument (the input BAM)
-        if (tok.empty() || tok[0] != '-') {
+        // Positional argument (the input BAM, "-" for stdin)
+        if (tok.empty() || tok[0] != '-' || tok == "-") {
             if (have_bam) {
                 std::cerr << "ERROR: Unexpected extra argument: \"" << tok << "\".\n";
                 return ParseStatus::Error;
@@ -154,6 +194,22 @@ inline ParseStatus argparse(int argc, char const **argv) {
         if (name == "-t" || name == "--threads") {
             if (!get_value(val) || !parse_int(val, ImpaqtArguments::Args.threads, name)) { return ParseStatus::Error; }
 
+        } else if (name == "-b" || name == "--bgzf-threads") {
+            if (!get_value(val) || !parse_int(val, ImpaqtArguments::Args.bgzf_threads, name)) { return ParseStatus::Error; }
+
+        } else if (name == "--tile-size") {
+            if (!get_value(val) || !parse_int(val, ImpaqtArguments::Args.tile_size, name)) { return ParseStatus::Error; }
+
+        } else if (name == "--ring-size") {
+            if (!get_value(val) || !parse_int(val, ImpaqtArguments::Args.ring_size, name)) { return ParseStatus::Error; }
+
+        } else if (name == "--max-memory") {
+            if (!get_value(val) || !parse_int(val, ImpaqtArguments::Args.max_memory, name)) { return ParseStatus::Error; }
+            if (ImpaqtArguments::Args.max_memory < 0) {
+                std::cerr << "ERROR: --max-memory must be 0 (no limit) or a size in MB.\n";
+                return ParseStatus::Error;
+            }
+
         } else if (name == "-a" || name == "--annotation") {
             if (!get_value(ImpaqtArguments::Args.annotation_file)) { return ParseStatus::Error; }
 
@@ -182,6 +238,13 @@ inline ParseStatus argparse(int argc, char const **argv) {
         } else if (name == "-d" || name == "--density-threshold") {
             if (!get_value(val) || !parse_double(val, ImpaqtArguments::Args.density_threshold, name)) { return ParseStatus::Error; }
 
+        } else if (name == "--dbscan-kernel") {
+            if (!get_value(ImpaqtArguments::Args.dbscan_kernel)) { return ParseStatus::Error; }
+            if (ImpaqtArguments::Args.dbscan_kernel != "linear" && ImpaqtArguments::Args.dbscan_kernel != "scan") {
+                std::cerr << "ERROR: --dbscan-kernel must be \"linear\" or \"scan\".\n";
+                return ParseStatus::Error;
+            }
+
         } else if (name == "-f" || name == "--feature-tag") {
             if (!get_value(ImpaqtArguments::Args.feature_tag)) { return ParseStatus::Error; }
 
@@ -207,21 +270,40 @@ inline ParseStatus argparse(int argc, char const **argv) {
         return ParseStatus::Error;
     }
 
+    // Stdin and pipes can only be read once, front to back
+    const bool piped = is_pipe(bam);
+    if (piped) { ImpaqtArguments::Args.stream = true; }
+    if (piped && ImpaqtArguments::Args.readahead) {
+        std::cerr << "// NOTICE: --readahead ignored; a pipe cannot be read ahead.\n";
+        ImpaqtArguments::Args.readahead = false;
+    }
+
     // Check file type of the input alignment
-    if (file_extension(bam) != "bam") {
+    if (!piped && file_extension(bam) != "bam") {
         std::cerr << "ERROR: Unaccepted File Format: \"." << file_extension(bam)
                   << "\". Only accepts \".bam\" extension.\n";
         return ParseStatus::Error;
     }
 
+#ifndef IMPAQT_USE_HTSLIB
+    if (ImpaqtArguments::Args.bgzf_threads > 0) {
+        std::cerr << "// NOTICE: --bgzf-threads ignored; this build decodes with bamtools (configure with -DUSE_HTSLIB=ON).\n";
+        ImpaqtArguments::Args.bgzf_threads = 0;
+    }
+#endif
+
     ImpaqtArguments::Args.alignment_file = bam;
     ImpaqtArguments::Args.index_file = bam + ".bai";
 
-    if (!file_exists(ImpaqtArguments::Args.alignment_file)) {
+    if (!piped && !file_exists(ImpaqtArguments::Args.alignment_file)) {
         std::cerr << "ERROR: Alignment file \"" << ImpaqtArguments::Args.alignment_file << "\" does not exist.\n";
         throw std::runtime_error("ERROR: Make sure alignment file exists.");
     }
 
+    if (ImpaqtArguments::Args.gtf_output == "" && bam == "-") {
+        std::cerr << "ERROR: Reading from stdin requires an output name (-o, --output-gtf).\n";
+        return ParseStatus::Error;
+    }
     if (ImpaqtArguments::Args.gtf_output == "") {
         ImpaqtArguments::Args.gtf_output = ImpaqtArguments::Args.alignment_file + ".gtf";
     }
@@ -11,7 +11,7 @@ GeneNode* get_closest_gene(const int &t, GeneNode *gene, const ClusterNode *clus
 /* Assignment Functions */
 
 // Resolve Read Assignment To Genes
-void resolve_read_assignment(GeneNode *gene, const int &max, std::vector<size_t> &read_assignments);
+void resolve_read_assignment(GeneNode *gene, const int &max, std::vector<size_t> &read_assignments, const size_t &weight = 1);
 
 // Resolve Read Assignment To Genes
 void resolve_transcript_assignment(ClusterList *list, ClusterNode *cluster, GeneNode *gene, const int &max, const int &i);
@@ -22,7 +22,7 @@ void resolve_transcript_assignment(ClusterList *list, ClusterNode *cluster, Gene
 int get_read_overlap(const int &a, const int &b, const GeneNode *gene);
 
 // Check the number of exons that overlap with transcript
-int get_transcript_overlap(const std::vector<int> &transcript, const GeneNode *gene);
+int get_transcript_overlap(const ExonSpan &transcript, const GeneNode *gene);
 
 // Compare overlap of genes to best match so far
 void compare_and_update_overlap(GeneNode *&gene, GeneNode *&best_gene, const int &overlap, int &max_overlap);
@@ -38,4 +38,4 @@ void assign_reads_to_genes(const ClusterNode *cluster, GeneNode *prev_gene, Clus
 
 /////////////////////////////////////////////////////////////
 /* Main Assignment Function */
-void assign_to_genes(AnnotationList &annotation, ClusterList *list, const std::string &chrom, const int &strand);
\ No newline at end of file
+void assign_to_genes(AnnotationList &annotation, ClusterList *list, const int &strand);
\ No newline at end of file
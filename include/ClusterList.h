@@ -1,15 +1,18 @@
 #pragma once
 
 #include <sstream>
-#include <api/BamAux.h>
-#include <api/BamReader.h>
 
+#include "AlignmentReader.h"
 #include "global_args.h"
 #include "utils.h"
 #include "ClusterNode.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/* Cluster Class (really just a doubly linked list) */
+/* Cluster Class (really just a doubly linked list)
+	Nodes live in one contiguous arena per strand, appended in start order
+	while reading and compacted in place when neighbours collapse, so every
+	pass walks memory front to back and teardown frees one block per strand.
+*/
 
 class ClusterList {
 
@@ -21,11 +24,20 @@ private:
 	int contig_length = 0;
 	int window_size;
 
-	// Links
-	ClusterNode *pos_head = nullptr;
-	ClusterNode *pos_tail = nullptr;
-	ClusterNode *neg_head = nullptr;
-	ClusterNode *neg_tail = nullptr;
+	// Tile Bounds (nominal start of this and the next tile, -1 = contig edge)
+	int tile_start = -1;
+	int tile_stop = -1;
+
+	// Windowed Batches (see create_clusters)
+	bool windowed = false;
+	int cut = -1;                             // first read of the next batch, -1 = contig end
+
+	// Node Arenas (by strand)
+	std::vector<ClusterNode> pos_nodes;
+	std::vector<ClusterNode> neg_nodes;
+
+	// Exon bounds of every transcript on this contig (both strands)
+	TranscriptPool transcript_pool;
 
 	// Summary
 	long double assigned_reads = 0.0;         // Assigned Transcript counts
@@ -44,11 +56,13 @@ private:
 
 	/////////////////////////////////////////////////////////////
 	/* Private Node Methods */
-	//void initialize_strand(ClusterNode *&head, ClusterNode *&tail, const int strand, const int &zones);
-	void initialize_list(const int t_strand, const int t_pos);
-	ClusterNode* extend_list(ClusterNode *&curr, const int t_strand, const int pos);
-	void merge_nodes(ClusterNode *&c_node, ClusterNode *&t_head, ClusterNode *&t_tail);
-	void delete_list();
+	std::vector<ClusterNode>& get_arena(const int t_strand) {
+		if (t_strand == 0) { return pos_nodes; }
+		return neg_nodes;
+	}
+	ClusterNode* extend_list(const int t_strand, const int t_pos);
+	void merge_nodes(ClusterNode *c_node, ClusterNode *n_node);
+	void relink(const int t_strand);
 
 public:
 
@@ -61,41 +75,47 @@ public:
 		this -> contig_length = contig_length;
 		this -> window_size = ImpaqtArguments::Args.window_size;
 	}
-	~ClusterList() { this -> delete_list(); }
+
+	// Nodes point back into the arenas (and the pool)
+	ClusterList(const ClusterList&) = delete;
+	ClusterList& operator=(const ClusterList&) = delete;
 
 	/////////////////////////////////////////////////////////////
 	/* Get Functions */
 
 	const std::string& get_contig_name() const { return contig_name; }
+	int get_contig_index() const { return contig_index; }
 
 	// Gets
-	ClusterNode* get_head(int t_strand) const {
-		if (t_strand == 0) { return pos_head; }
-		return neg_head;
+	ClusterNode* get_head(int t_strand) {
+		std::vector<ClusterNode> &nodes = get_arena(t_strand);
+		return nodes.empty() ? nullptr : &nodes.front();
 	}
-	ClusterNode* get_tail(int t_strand) const {
-		if (t_strand == 0) { return pos_tail; }
-		return neg_tail;
+	ClusterNode* get_tail(int t_strand) {
+		std::vector<ClusterNode> &nodes = get_arena(t_strand);
+		return nodes.empty() ? nullptr : &nodes.back();
 	}
 
-	// Sets
-	void set_head(ClusterNode* node, const int t_strand) {
-		if (t_strand == 0) {
-			pos_head = node;
-		} else {
-			neg_head = node;
-		}
-	}
-	void set_tail(ClusterNode* node, const int t_strand) {
-		if (t_strand == 0) {
-			pos_tail = node;
-		} else {
-			neg_tail = node;
+	// Where the last batch stopped (see set_windowed)
+	int get_cut() const { return cut; }
+
+	// Last transcript base on either strand (-1 if none): a later node can only collapse into one reaching it
+	int get_transcript_stop() const {
+		int last = -1;
+		for (const std::vector<ClusterNode> *nodes : {&pos_nodes, &neg_nodes}) {
+			for (const ClusterNode &node : *nodes) { last = std::max(last, node.get_transcript_stop()); }
 		}
+		return last;
 	}
 
+	// Sets
+	void set_tile(const int t_start, const int t_stop) { tile_start = t_start; tile_stop = t_stop; }
+	void set_windowed() { windowed = true; }
+
 	// Get First cluster by position (just trust me on this one)
-	ClusterNode* get_first_cluster(bool &strand) const {
+	ClusterNode* get_first_cluster(bool &strand) {
+		ClusterNode *pos_head = get_head(0);
+		ClusterNode *neg_head = get_head(1);
 		if (pos_head == nullptr && neg_head != nullptr) {
 			strand = 1; return neg_head;
 		} else if (neg_head == nullptr && pos_head != nullptr) {
@@ -141,12 +161,9 @@ public:
 	// Get Transcript Number
 	size_t get_transcript_num() const {
 		size_t total = 0;
-		ClusterNode *node = pos_head;
-		for (int i = 0; i < 2; i ++) {
-			if (i != 0) { node = neg_head; }
-			while (node != nullptr) {
-				if (!(node -> is_skipped())) { total += node -> get_transcript_num(); }
-				node = node -> get_next();
+		for (const std::vector<ClusterNode> *nodes : {&pos_nodes, &neg_nodes}) {
+			for (const ClusterNode &node : *nodes) {
+				if (!(node.is_skipped())) { total += node.get_transcript_num(); }
 			}
 		}
 		return total;
@@ -154,8 +171,9 @@ public:
 
 	/////////////////////////////////////////////////////////////
 	/* Private Alignment Methods */
-	void calculate_splice(BamTools::BamAlignment &alignment, std::vector<int> &positions, std::vector<int> &junctions);
-	bool read_check(const BamTools::BamAlignment &alignment);
+	void calculate_splice(const AlignmentRecord &alignment, std::vector<int> &positions, std::vector<int> &junctions);
+	void add_splice(ClusterNode *node, const AlignmentRecord &alignment);
+	bool read_check(AlignmentReader &inFile, AlignmentRecord &alignment);
 
 	/////////////////////////////////////////////////////////////
 	/* Counting Functions */
@@ -180,19 +198,20 @@ public:
 
 	/////////////////////////////////////////////////////////////
 	/* Cluster Functions */
-	bool create_clusters(BamTools::BamReader &inFile, BamTools::BamAlignment &alignment);
+	bool create_clusters(AlignmentReader &inFile, AlignmentRecord &alignment);
 	void collapse_clusters(int t_strand);
+	void append_list(ClusterList *tile);
 
 	/////////////////////////////////////////////////////////////
 	/* Output Functions */
-	void write_clusters_as_GTF(std::ofstream &gtfFile);
+	void write_clusters_as_GTF(std::ostream &gtfFile);
 
 	/////////////////////////////////////////////////////////////
 	/* Functions for Testing Suite */
 	void print_clusters(int t_strand) {
 		ClusterNode *node = get_head(t_strand);
 		while (node != nullptr) {
-			std::cout << node -> get_contig_name() << "\t"
+			std::cout << contig_name << "\t"
 			          << node -> get_start() << "\t" << node -> get_stop() << "\t"
 			          << node -> get_read_count() << "\n";
 			node = node -> get_next();
@@ -203,7 +222,7 @@ public:
 		std::stringstream ss;
 		ClusterNode *node = get_head(t_strand);
 		while (node != nullptr) {
-			ss << node -> get_contig_name() << "\t"
+			ss << contig_name << "\t"
 			   << node -> get_start() << "\t" << node -> get_stop() << "\t"
 			   << node -> get_read_count() << "\n";
 			node = node -> get_next();
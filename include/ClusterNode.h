@@ -1,22 +1,24 @@
 #pragma once
 
 #include <fstream>
-#include <numeric>
 #include <vector>
+#include <utility>
 #include <algorithm>
 
 #include "global_args.h"
 #include "utils.h"
+#include "PointStore.h"
+#include "JunctionIndex.h"
+#include "TranscriptPool.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-/* Cluster Node Class (really just a node in a doubly linked list) */
+/* Cluster Node Class (really just a node in a doubly linked list, stored in ClusterList's per-strand arena) */
 
 class ClusterNode {
 
 private:
 
-	// Node Details
-	std::string contig_name;
+	// Node Details (the contig's name lives on its ClusterList)
 	int contig_index;
 	int strand = -1;
 	int start;
@@ -28,20 +30,25 @@ private:
 	size_t read_count = 0;                             // number of associated reads
 	size_t vec_count = 0;                              // number of points (gapped alns starts and ends)
 	size_t total_core_points = 0;                      // number of total core points
-	std::vector<int> five_vec;                         // vector for 5' ends
-	std::vector<int> three_vec;                        // vector for 3' ends
-	std::vector<int> index_vec;                        // vector for read indexes
-	std::vector<int> junctions;                        // splice junctions (determined by alignments)
+	PointStore points;                                 // 5'/3' ends, read runs and weights (packed)
+	JunctionIndex junctions;                           // splice junctions (determined by alignments), counted
 
-	// Links
-	ClusterNode *next = nullptr;
-	ClusterNode *prev = nullptr;
+	// Duplicate Folding (see close_read)
+	size_t run_first = 0;                              // first stored read of the reads sharing its start
+	std::vector<std::pair<uint64_t, uint32_t>> run_reads;  // (PointStore::read_hash, read) of that run, reused
+	size_t run_sorted = 0;                             // run_reads before this are sorted (deep runs, see close_read)
+	static constexpr size_t run_tail = 32;             // unsorted reads scanned before the tail is merged in
 
-	// Transcript Results
+	// Links (list order is arena order, so neighbours are the adjacent slots)
+	std::vector<ClusterNode> *arena = nullptr;
+	int index = -1;
+
+	// Transcript Results (exon bounds live in the contig's pool, see TranscriptPool)
+	TranscriptPool *pool = nullptr;
 	size_t transcript_num = 0;                         // number of transcripts identified
-	std::vector<std::vector<int>> transcript_vec;      // vector of transcript regions
+	std::vector<TranscriptSpan> transcript_spans;      // where each transcript's bounds are in the pool
 	std::vector<long double> transcript_expression;    // vector of transcript expression
-	std::vector<std::string> transcript_assignments;   // vector of transcript assignments
+	std::vector<int> transcript_assignments;           // gene ordinal in the pool (or unassigned / ambiguous)
 
 
 public:
@@ -52,57 +59,15 @@ public:
 	// Empty
 	ClusterNode() {}
 
-	// Initialize
-	ClusterNode(const int &start, const int strand,  const int &window_size, const int &contig_index, const std::string &contig_name) {
+	// Initialize (point vectors start empty and grow geometrically: most windows only ever see a few reads)
+	ClusterNode(const int &start, const int strand,  const int &window_size, const int &contig_index) {
 		this -> start = start;
 		this -> stop = start + window_size;
 		this -> strand = strand;
 		this -> contig_index = contig_index;
-		this -> contig_name = contig_name;
-		five_vec.reserve(1000);
-		three_vec.reserve(1000);
-		index_vec.reserve(1000);
-	}
-
-	// For combined Nodes 
-	ClusterNode(ClusterNode *c_node, ClusterNode *n_node) {
-
-		// BNJ (7/4/2023): replace with a swallow function. Avoid making an entirely new object
-
-		int c_vec = c_node -> get_vec_count();
-		int n_vec = n_node -> get_vec_count();
-		int c_junc = c_node -> get_junct_vec().size();
-		int n_junc = n_node -> get_junct_vec().size();
-
-		start = c_node -> get_start();
-		stop = n_node -> get_stop();
-		strand = c_node -> get_strand();
-		contig_name = c_node -> get_contig_name();
-		contig_index = c_node -> get_contig_index();
-		vec_count = c_vec + n_vec;
-		read_count = c_node -> get_read_count() + n_node -> get_read_count();
-
-		// Necessary Copy, Resize, Overwrite
-		five_vec = c_node -> get_five_vec();
-		five_vec.resize(vec_count, 0);
-		for (int i = 0; i < n_vec; i++) { five_vec.at(c_vec + i) = n_node -> get_five_vec().at(i); }
-
-		three_vec = c_node -> get_three_vec();
-		three_vec.resize(vec_count, 0); // Resize to fit both nodes
-		for (int i = 0; i < n_vec; i++) { three_vec.at(c_vec + i) = n_node -> get_three_vec().at(i); }
-
-		junctions = c_node -> get_junct_vec();
-		junctions.resize(c_junc + n_junc, 0); // Resize to fit both nodes
-		for (int i = 0; i < n_junc; i++) { junctions.at(c_junc + i) = n_node -> get_junct_vec().at(i); }
-
-		index_vec = c_node -> get_index_vec(); 
-		index_vec.resize(vec_count, 0);
-		for (int i = 0; i < n_vec; i++) { index_vec.at(c_vec + i) = c_vec + n_node -> get_index_vec().at(i); }
+		this -> points = PointStore(start);
 	}
 
-	// Destroy
-	~ClusterNode() { next = nullptr; prev = nullptr; }
-
 	/////////////////////////////////////////////////////////////
 	/* Get Functions */
 
@@ -111,23 +76,27 @@ public:
 	int get_start() const { return start; }
 	int get_stop() const { return stop; }
 
-	const std::string& get_contig_name() const { return contig_name; }
 	const std::string& get_headID() const { return headID; }
 
 	size_t get_read_count() const { return read_count; }
 	size_t get_vec_count() const { return vec_count; }
 
-	const std::vector<int>& get_five_vec() const { return five_vec; }
-	const std::vector<int>& get_three_vec() const { return three_vec; }
-	const std::vector<int>& get_junct_vec() const { return junctions; }
-	const std::vector<int>& get_index_vec() const { return index_vec; }
-	std::vector<int>* get_five_ref() { return &five_vec; }
-	std::vector<int>* get_three_ref() { return &three_vec; }
-	std::vector<int>* get_index_ref() { return &index_vec; }
+	const JunctionIndex& get_junctions() const { return junctions; }
+	const PointStore& get_points() const { return points; }
+
+	// Point i (absolute positions)
+	int get_five(const int &i) const { return points.five(i); }
+	int get_three(const int &i) const { return points.three(i); }
+
+	// Reads behind point i (points without a stored read count once)
+	int get_weight(const int &i) const {
+		return (i < (int)points.size()) ? points.read_weight(points.read_of(i)) : 1;
+	}
+	std::vector<int> get_point_weights() const { return points.point_weights(); }
 	
 	// Reset trancript vars
 	void clear_transcripts() {
-		transcript_vec.clear();
+		transcript_spans.clear();
 		transcript_expression.clear();
 		transcript_assignments.clear();
 		transcript_num = 0;
@@ -135,18 +104,20 @@ public:
 	}
 
 	size_t get_transcript_num() const { return transcript_num; }
-	std::vector<std::vector<int>>* get_transcripts() { return &transcript_vec; }
+	ExonSpan get_transcript(const int &i) const { return pool -> get(transcript_spans[i]); }
 	std::vector<long double> get_transexpr_vec() const { return transcript_expression; }
+	const std::string& get_transcript_assignment(const int &i) const { return pool -> gene_name(transcript_assignments[i]); }
 
 	int get_transcript_start() const {
-		if (transcript_vec.empty()) { return -1; }
-		return transcript_vec[0][0];
+		if (transcript_spans.empty()) { return -1; }
+		return this -> get_transcript(0).front();
 	}
 	int get_transcript_stop() const {
-		if (transcript_vec.empty()) { return -1; }
-		int last = transcript_vec[0].back();
-		for (const auto &t: transcript_vec) {
-			if (t.back() > last) { last = t.back(); }
+		if (transcript_spans.empty()) { return -1; }
+		int last = this -> get_transcript(0).back();
+		for (const auto &span : transcript_spans) {
+			const int t_last = pool -> get(span).back();
+			if (t_last > last) { last = t_last; }
 		}
 		return last;
 	}
@@ -157,27 +128,31 @@ public:
 		return transcript_expression.at(i);
 	}
 
-	ClusterNode* get_next() const { return next; }
-	ClusterNode* get_prev() const { return prev; }
+	ClusterNode* get_next() const {
+		if (arena == nullptr || index + 1 >= (int)arena -> size()) { return nullptr; }
+		return &(*arena)[index + 1];
+	}
+	ClusterNode* get_prev() const {
+		if (arena == nullptr || index <= 0) { return nullptr; }
+		return &(*arena)[index - 1];
+	}
 
 	bool is_skipped() const { return skip; }
 	bool read_contained(const int pos) const { return check_point_overlap(pos, this -> get_start(), this -> get_stop()); }
-	bool contains_junction(const int &a, const int &b) const {
-		for (const auto &j : junctions) {
-			if (j >= a && j <= b) {
-				return true;
-			}
-		}
-		return false;
-	}
+	bool contains_junction(const int &a, const int &b) const { return junctions.contains(a, b); }
 
 
 
 	/////////////////////////////////////////////////////////////
 	/* Set Functions */
 
-	void set_next(ClusterNode *node) { next = node; }
-	void set_prev(ClusterNode *node) { prev = node; }
+	void set_link(std::vector<ClusterNode> *t_arena, const int t_index) { arena = t_arena; index = t_index; }
+	void set_pool(TranscriptPool *t_pool) { pool = t_pool; }
+
+	// Pool moved onto the end of another (see TranscriptPool::append)
+	void rebase_transcripts(const uint32_t &shift) {
+		for (auto &span : transcript_spans) { span.offset += shift; }
+	}
 	void set_contig_index(int t_contig_index) { contig_index = t_contig_index; }
 	void set_skip() { skip = true; }
 	void update_read_counts(size_t count) { read_count += count; }
@@ -185,89 +160,139 @@ public:
 	void update_start(int t_start) { start = t_start; }
 	void update_stop(int t_stop) { stop = t_stop; }
 	void empty_vectors() {
-		five_vec.clear(); five_vec.shrink_to_fit();
-		three_vec.clear(); three_vec.shrink_to_fit();
-		index_vec.clear(); index_vec.shrink_to_fit();
+		points.clear();
 		vec_count = 0;
+		run_first = 0;
+		std::vector<std::pair<uint64_t, uint32_t>>().swap(run_reads);
+		run_sorted = 0;
 	}
 
 	/////////////////////////////////////////////////////////////
 	/* Read Vector Functions */
 
-	// Add alignment to cluster
+	// Add alignment to cluster (positions are 5'/3' pairs, as from ClusterList::calculate_splice)
 	void add_alignment(const std::vector<int> &positions, const std::vector<int> &junctions) {
-
 		const int n = positions.size();
+		for (int i = 0; i + 1 < n; i += 2) { this -> add_block(positions[i], positions[i + 1]); }
+		for (const int junction : junctions) { this -> add_junction(junction); }
+		this -> close_read();
+	}
 
-		// Add positions to 5' and 3' vecs (amortized growth via push_back)
-		for (int i = 0; i < n; i++) {
-			if (i % 2 == 0) {
-				five_vec.push_back(positions[i]);
-				index_vec.push_back(read_count); // Store index for sorting
-			} else {
-				three_vec.push_back(positions[i]);
-				vec_count += 1;
-			}
-		}
-
-		for (const int junction : junctions) {
-			this -> junctions.push_back(junction);
-		}
+	// Same as add_alignment, one aligned block at a time (see ClusterList::add_splice)
+	void add_block(const int five, const int three) {
+		points.push(five, three);
+		vec_count += 1;
+	}
+	void add_junction(const int junction) { junctions.add(junction); }
+
+	/*
+	  Finish the read just added. Reads arrive in start order, so an identical
+	  read (same 5'/3' pairs) can only be among those sharing its start, which
+	  are kept with their hashes: if one is found the new read is dropped and
+	  that read gains a weight. The run is scanned as it grows; once a deep run
+	  has more than run_tail unsorted reads they are merged into a sorted
+	  prefix that is searched by hash.
+	  Its junctions were already counted as they were added.
+	*/
+	void close_read() {
 
 		read_count += 1;
-	}
+		if (points.size() == points.open_begin()) { return; }
+
+		points.close_read();
+		const size_t r = points.reads() - 1;
+
+		const uint64_t key = points.read_hash(r);
 
-	// Remove ends of vectors
-	void shrink_vectors() {
-		five_vec.resize(vec_count); five_vec.shrink_to_fit();
-		three_vec.resize(vec_count); three_vec.shrink_to_fit();
-		index_vec.resize(vec_count); index_vec.shrink_to_fit();
+		// New start position opens a new run
+		if (run_first == r || points.five(points.read_begin(run_first)) != points.five(points.read_begin(r))) {
+			run_first = r;
+			run_reads.clear();
+			run_sorted = 0;
+		} else if (this -> fold_duplicate(r, key)) {
+			return;
+		}
+		run_reads.emplace_back(key, r);
+		if (run_reads.size() - run_sorted > run_tail) {
+			std::sort(run_reads.begin() + run_sorted, run_reads.end());
+			std::inplace_merge(run_reads.begin(), run_reads.begin() + run_sorted, run_reads.end());
+			run_sorted = run_reads.size();
+		}
 	}
 
-	// Sort Vectors
-	void sort_vectors(const std::vector<int> &indices) {
-		std::vector<int> tmp_vec(vec_count);
-		for (int i = 0; i < vec_count; i++) { tmp_vec[i] = five_vec[indices[i]]; }
-		five_vec = tmp_vec;
-		for (int i = 0; i < vec_count; i++) { tmp_vec[i] = three_vec[indices[i]]; }
-		three_vec = tmp_vec;
-		for (int i = 0; i < vec_count; i++) { tmp_vec[i] = index_vec[indices[i]]; }
-		index_vec = tmp_vec;
+	bool fold_duplicate(const size_t &r, const uint64_t &key) {
+		const auto sorted_end = run_reads.begin() + run_sorted;
+		auto it = std::lower_bound(run_reads.begin(), sorted_end, std::make_pair(key, (uint32_t)0));
+		for (; it != sorted_end && it -> first == key; ++it) {
+			if (this -> fold_into(it -> second, r)) { return true; }
+		}
+		for (it = sorted_end; it != run_reads.end(); ++it) {
+			if (it -> first == key && this -> fold_into(it -> second, r)) { return true; }
+		}
+		return false;
+	}
+	bool fold_into(const uint32_t &kept, const size_t &r) {
+		if (!points.same_read(kept, r)) { return false; }
+		points.fold_last_into(kept);
+		vec_count = points.size();
+		return true;
 	}
 
-	// Sort Point Vectors By 5' Positions
-	void point_sort_vectors() {
-		std::vector<int> indices(vec_count);
-		std::iota(indices.begin(), indices.end(), 0);
-		std::sort(indices.begin(), indices.end(),
-			       [&](int i, int j) -> bool {
-			            return five_vec[i] < five_vec[j];
-			        }
-		         );
-		sort_vectors(indices);
+	/*
+	  Swallow the following node: its reads are appended after this node's
+	  (rebased onto this node's start) and its storage released. This node's
+	  storage grows geometrically, so merging a locus window by window stays
+	  linear in its points.
+	*/
+	void absorb(ClusterNode &n_node) {
+
+		points.load();
+		n_node.points.load();
+		points.append(n_node.points);
+		junctions.merge(n_node.junctions);
+
+		stop = n_node.stop;
+		vec_count += n_node.vec_count;
+		read_count += n_node.read_count;
+
+		// Reads never arrive after a merge, so nothing left to fold into
+		run_first = points.reads();
+		std::vector<std::pair<uint64_t, uint32_t>>().swap(run_reads);
+		run_sorted = 0;
+
+		n_node.empty_vectors();
+		n_node.junctions.clear();
+		n_node.read_count = 0;
 	}
 
-	// Sort Point Vectors By Index
-	void index_sort_vectors() {
-		std::vector<int> indices(vec_count);
-		std::iota(indices.begin(), indices.end(), 0);
-		std::sort(indices.begin(), indices.end(),
-			       [&](int i, int j) -> bool {
-			            return index_vec[i] < index_vec[j];
-			        }
-		         );
-		sort_vectors(indices);
+	// Release spare point storage (see PointStore::shrink)
+	void shrink_vectors() { points.shrink(); junctions.shrink(); }
+
+	// No more points for now: drop the duplicate run, and under --max-memory count the points and
+	//	spill them if the budget is spent. Anything reading points after a stage boundary calls load_points() first.
+	void settle_points() {
+		std::vector<std::pair<uint64_t, uint32_t>>().swap(run_reads);
+		run_sorted = 0;
+		if (!PointSpill::enabled()) { return; }
+		points.settle();
+		if (PointSpill::over_budget()) { points.spill(); }
 	}
+	void load_points() { points.load(); }
+
+	// Hand f the raw offset pairs (see PointStore::visit)
+	template <typename F>
+	auto visit_points(F &&f) const { return points.visit(std::forward<F>(f)); }
+	int get_point_base() const { return points.get_base(); }
 
 
 	/////////////////////////////////////////////////////////////
 	/* Transcript Functions */
 
 	// add transcript
-	void add_transcript(const std::vector<int> &t_trans, const int &t_expr) {
-		transcript_vec.push_back(t_trans); // Copy, I know
+	void add_transcript(const ExonSpan &t_trans, const int &t_expr) {
+		transcript_spans.push_back(pool -> add(t_trans));
 		transcript_expression.push_back((long double)t_expr);
-		transcript_assignments.emplace_back("Unassigned");
+		transcript_assignments.push_back(TranscriptPool::unassigned);
 		total_core_points += t_expr;
 		transcript_num += 1;
 	}
@@ -276,7 +301,7 @@ public:
 	void quantify_transcripts() {
 		long double prop, quant;
 		long double denom = total_core_points;
-		for (int i = 0; i < transcript_vec.size(); i++) {
+		for (int i = 0; i < transcript_spans.size(); i++) {
 			prop = transcript_expression.at(i) / denom;
 			if (prop == 1) {
 				quant = (long double)read_count;
@@ -288,14 +313,14 @@ public:
 	}
 
 	// assign transcripts
-	void assign_transcript(const std::string &t_gene_id, const int &i) { transcript_assignments[i] = t_gene_id; }
-	void assign_ambiguous(const int &i) { transcript_assignments[i] = "Ambiguous"; }
+	void assign_transcript(const std::string &t_gene_id, const int &i) { transcript_assignments[i] = pool -> gene_ordinal(t_gene_id); }
+	void assign_ambiguous(const int &i) { transcript_assignments[i] = TranscriptPool::ambiguous; }
 
 	/////////////////////////////////////////////////////////////
 	/* Output Functions */
 
 	// Print Transcripts
-	void write_transcripts(std::ofstream &gtfFile) {
+	void write_transcripts(std::ostream &gtfFile, const std::string &contig_name) {
 
 		// Skip if swallowed by neighboring cluster or no transcripts
 		if (this -> is_skipped() || transcript_num == 0) { return; }
@@ -304,7 +329,7 @@ public:
 		float quant;
 		int regions = 0;
 		int start, stop, x_start, x_stop;
-		std::string gene_id, assignment;
+		std::string gene_id;
 
 		// Set Strand
 		if (ImpaqtArguments::Args.stranded == "reverse") {
@@ -326,16 +351,17 @@ public:
 		        << "gene_id \"" << gene_id << "\";"
 		        << " region \"" << contig_name << ":" 
 		        << this -> get_start() << "-" << this -> get_stop() << "\";"
-		        << " transcripts \"" << transcript_vec.size() << "\";"
+		        << " transcripts \"" << transcript_spans.size() << "\";"
 		        << " counts \"" << read_count << "\";\n";
 
-		for (int i = 0; i < transcript_vec.size(); i++) {
+		for (int i = 0; i < transcript_spans.size(); i++) {
 
-			regions	= transcript_vec.at(i).size();
-			start = transcript_vec.at(i).at(0) + 1;
-			stop = transcript_vec.at(i).at(regions - 1) + 1;
+			const ExonSpan transcript = this -> get_transcript(i);
+			const std::string &assignment = pool -> gene_name(transcript_assignments[i]);
+			regions	= transcript.size();
+			start = transcript.front() + 1;
+			stop = transcript.back() + 1;
 			quant = transcript_expression.at(i);
-			assignment = transcript_assignments.at(i);
 
 			// Print Transcript Line
 			gtfFile << contig_name << "\tImpaqt\ttranscript\t"
@@ -351,8 +377,8 @@ public:
 			// Print Exon Line
 			for (int j = 0; j < regions; j += 2) {
 
-				x_start = transcript_vec.at(i).at(j) + 1;
-				x_stop = transcript_vec.at(i).at(j + 1) + 1;
+				x_start = transcript[j] + 1;
+				x_stop = transcript[j + 1] + 1;
 
 				gtfFile << contig_name << "\tImpaqt\texon\t"
 				        << x_start << "\t" << x_stop << "\t.\t" << strand  << "\t.\t"
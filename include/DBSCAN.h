@@ -1,5 +1,10 @@
 #pragma once
 
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /* DBSCAN and Related Functions */
 
@@ -15,6 +20,29 @@ struct Path {
 	}
 };
 
+// Marks over a reused buffer: point i is marked when its stamp is the current epoch,
+//	so clearing every mark is one increment (the buffer only grows, and is
+//	wiped once every 2^32 resets when the epoch wraps).
+class EpochMarks {
+
+private:
+
+	std::vector<uint32_t> stamps;
+	uint32_t epoch = 0;
+
+public:
+
+	void reset(const size_t &n) {
+		if (stamps.size() < n) { stamps.resize(n, 0); }
+		if (++epoch == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			epoch = 1;
+		}
+	}
+	bool test(const size_t &i) const { return stamps[i] == epoch; }
+	void set(const size_t &i) { stamps[i] = epoch; }
+};
+
 // Check if transcripts overlap / are contained in another transcript
 bool check_subset(const std::vector<int>& a, const std::vector<int>& b);
 
@@ -36,17 +64,28 @@ void get_coordinates(const std::map<Path, int> &paths,
                      std::vector<std::vector<int>> *transcripts, std::vector<int> *counts);
 
 // Find all linked DBSCAN clusters
+//	weights: the node's point weights (see ClusterNode::get_point_weights), built here if not given
 void get_linked_clusters(ClusterNode *curr_node, std::map<Path, int> &path_map,
-                         const std::vector<int> &assign_5, const std::vector<int> &assign_3);
+                         const std::vector<int> &assign_5, const std::vector<int> &assign_3,
+                         const std::vector<int> *weights = nullptr);
+
+// Get Nearest neighbors of sorted point i in DBSCAN into neighbors (weight: reads behind them)
+//	sorted: point offsets in ascending order (uint16_t or uint32_t, see PointStore)
+//	queued: marks each neighbor found, if given
+template <typename T>
+void get_nearest_neighbors(const int &i, const int &points, EpochMarks *queued,
+                           const std::vector<T> &sorted, const std::vector<int> &sorted_weights,
+                           std::vector<int> &neighbors, int &weight);
 
-// Get Nearest neighbors for Indices in DBSCAN
-std::vector<int> get_nearest_neighbors(const int &i, const int &points, std::vector<bool> &queued,
-                                       const std::vector<int> &indices, const std::vector<int> *adj_vec);
 
+// Points per thread from which the linear DBSCAN splits a node across spare --threads (tests lower it)
+void set_dbscan_parallel_points(const int &points);
 
 // DBSCAN Clustering Function, inspired by https://github.com/Eleobert/dbscan/blob/master/dbscan.cpp
+//	weights: as for get_linked_clusters
 std::vector<int> dbscan(ClusterNode *curr_node, const int &points, const int &min_counts,
-                        std::map<int, std::vector<int>> &regions, const bool &five);
+                        std::map<int, std::vector<int>> &regions, const bool &five,
+                        const std::vector<int> *weights = nullptr);
 
 // Initiate Transcript Identifying Procedure
 void identify_transcripts_dbscan(ClusterList *cluster,  const int &strand);
@@ -11,7 +11,8 @@ private:
 
 	// Node Details
 	std::string geneID;                          // read ID of first read in cluster
-	std::string chrom;                           // chromosome index
+	std::string chrom;                           // chromosome name (as annotated)
+	int contig_id = -1;                          // alignment RefID of chrom (-1 = not in the BAM)
 	int strand = -1;                             // standedness
 	int start;                                   // beginning of window
 	int stop;                                    // end of window
@@ -111,6 +112,7 @@ public:
 	/* Get Functions */
 
 	const std::string& get_chrom() const { return chrom; }
+	int get_contig_id() const { return contig_id; }
 	const std::string& get_geneID() const { return geneID; }
 	
 	int get_strand() const { return strand; }
@@ -131,6 +133,7 @@ public:
 
 	void set_next(GeneNode *node) { next = node; }
 	void set_prev(GeneNode *node) { prev = node; }
+	void set_contig_id(const int t_contig_id) { contig_id = t_contig_id; }
 
 	/////////////////////////////////////////////////////////////
 	/* Gene Functions */
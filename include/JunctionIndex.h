@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Junction Index Class
+	A node's splice junctions, one entry per distinct position with the number
+	of reads that carried it. Positions are kept sorted, so lookups are binary
+	searches. Reads arrive in start order, so a new junction almost always lands
+	at (or near) the end and inserting it moves little.
+*/
+
+class JunctionIndex {
+
+private:
+
+	std::vector<int> positions;                // sorted, distinct
+	std::vector<uint32_t> counts;              // reads behind each position
+
+public:
+
+	/////////////////////////////////////////////////////////////
+	/* Get Functions */
+
+	size_t size() const { return positions.size(); }
+	bool empty() const { return positions.empty(); }
+	int position(const size_t &i) const { return positions[i]; }
+	uint32_t count(const size_t &i) const { return counts[i]; }
+
+	// Reads carrying junction j (0 if none)
+	uint32_t count_at(const int &j) const {
+		auto it = std::lower_bound(positions.begin(), positions.end(), j);
+		if (it == positions.end() || *it != j) { return 0; }
+		return counts[it - positions.begin()];
+	}
+
+	// Any junction in [a, b]
+	bool contains(const int &a, const int &b) const {
+		auto it = std::lower_bound(positions.begin(), positions.end(), a);
+		return it != positions.end() && *it <= b;
+	}
+
+	bool operator==(const JunctionIndex &other) const { return positions == other.positions && counts == other.counts; }
+
+	/////////////////////////////////////////////////////////////
+	/* Junction Functions */
+
+	void add(const int &j, const uint32_t &n = 1) {
+
+		// Common case: at or past the last junction
+		if (positions.empty() || j > positions.back()) {
+			positions.push_back(j);
+			counts.push_back(n);
+			return;
+		}
+		if (j == positions.back()) { counts.back() += n; return; }
+
+		auto it = std::lower_bound(positions.begin(), positions.end(), j);
+		const size_t i = it - positions.begin();
+		if (*it == j) { counts[i] += n; return; }
+		positions.insert(it, j);
+		counts.insert(counts.begin() + i, n);
+	}
+
+	// Fold another index into this one (one merge pass, counts summed)
+	void merge(const JunctionIndex &other) {
+
+		if (other.empty()) { return; }
+		if (this -> empty() || other.positions.front() > positions.back()) {
+			positions.insert(positions.end(), other.positions.begin(), other.positions.end());
+			counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+			return;
+		}
+
+		std::vector<int> t_positions;
+		std::vector<uint32_t> t_counts;
+		t_positions.reserve(positions.size() + other.positions.size());
+		t_counts.reserve(positions.size() + other.positions.size());
+
+		size_t i = 0, k = 0;
+		const size_t n = positions.size(), m = other.positions.size();
+		while (i < n || k < m) {
+			if (k == m || (i < n && positions[i] < other.positions[k])) {
+				t_positions.push_back(positions[i]); t_counts.push_back(counts[i]); i++;
+			} else if (i == n || other.positions[k] < positions[i]) {
+				t_positions.push_back(other.positions[k]); t_counts.push_back(other.counts[k]); k++;
+			} else {
+				t_positions.push_back(positions[i]); t_counts.push_back(counts[i] + other.counts[k]); i++; k++;
+			}
+		}
+		positions.swap(t_positions);
+		counts.swap(t_counts);
+	}
+
+	// Drop spare capacity, only when more than half of it is spare (as PointStore::shrink)
+	void shrink() {
+		if (positions.capacity() <= 2 * positions.size()) { return; }
+		positions.shrink_to_fit();
+		counts.shrink_to_fit();
+	}
+
+	void clear() {
+		std::vector<int>().swap(positions);
+		std::vector<uint32_t>().swap(counts);
+	}
+};
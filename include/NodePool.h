@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Node Pool Class
+	One work-stealing pool for all of a run's work: the contig (and tile) jobs,
+	the per-node DBSCAN of every contig (see identify_transcripts_dbscan) and
+	the chunks of deep nodes. It has --threads - 1 workers; the main thread
+	makes up the last one, reading (--stream) or helping once it waits.
+	Contig jobs are roots, kept in one FIFO. Every other task goes on the deque
+	of the thread that submits it: that thread takes its newest task from the
+	back, and when it is empty steals the oldest task of another deque from the
+	front. Workers only start a new root when no deque has a task, so contigs
+	already running finish before more are opened. A thread waiting on a group
+	runs tasks too (never roots, unless it waits on roots), so a contig joining
+	its nodes helps with whatever is queued rather than sleeping.
+	Not started (tests, benchmarks, --threads 1): submit runs the task inline.
+*/
+
+class NodePool {
+
+	typedef std::function<void(void)> call;
+
+public:
+
+	// Tasks one caller waits on
+	class Group {
+
+		friend class NodePool;
+
+	private:
+
+		int pending = 0;                           // guarded by mlock
+		bool roots = false;                        // contig jobs (see submit_root), guarded by mlock
+		std::mutex mlock;
+		std::condition_variable cv;
+	};
+
+private:
+
+	struct Task {
+		call job;
+		Group *group = nullptr;
+	};
+
+	struct Deque {
+		std::mutex mlock;
+		std::deque<Task> tasks;
+	};
+
+	static std::vector<std::unique_ptr<Deque>> deques;   // workers first, then one per outside thread
+	static Deque roots;                                  // contig jobs, oldest first
+	static std::vector<std::thread> workers;
+	static std::atomic<int> outside;                     // outside threads given a deque
+	static std::atomic<int> queued;                      // tasks in any deque, and roots
+	static std::mutex sleep_lock;
+	static std::condition_variable sleep_cv;
+	static bool quit;
+
+	// Summary
+	static int pool_threads;
+	static std::atomic<size_t> tasks_run;
+	static std::atomic<size_t> steals;
+
+	static int home();
+	static bool take(const int &self, Task &task, const bool &take_roots);
+	static bool take_own(Group &group, Task &task);
+	static void run(Task &task);
+	static void worker(const int i);
+
+public:
+
+	// Start `threads` workers; outside threads is how many other threads may submit
+	static void start(const int &threads, const int &outside_threads);
+	static void stop();
+	static bool running() { return !workers.empty(); }
+
+	static void submit(Group &group, call job);
+	static void submit_root(Group &group, call job);
+	static void wait(Group &group);
+
+	// Wait without running other groups' tasks (for a caller holding per-thread state, such
+	//	as DBSCAN scratch, that a task run here could reuse): this group's tasks still on
+	//	this thread's deque are run here, the rest are already running elsewhere
+	static void join(Group &group);
+
+	static void print_stats(std::ostream &out);
+};
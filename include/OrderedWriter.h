@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Ordered Writer Class
+	Contigs finish in any order but are written in contig order. complete(i)
+	marks contig i done; one thread at a time (the writer) then takes the run
+	of finished contigs from the first unwritten one up to the next gap and
+	flushes it outside the lock, taking further runs until none is left. A
+	contig completing meanwhile is left for the writer, so completing never
+	waits on output. A contig waits only on the contigs before it, not on the
+	whole run. A contig that writes as it goes (--windowed) can also hand
+	over finished parts with write_part, written at once while it is the
+	first unwritten contig.
+*/
+
+class OrderedWriter {
+
+	typedef std::function<void(const int&)> flush_call;
+	typedef std::function<void(void)> part_call;
+
+private:
+
+	std::mutex mlock;
+	std::vector<bool> done;
+	int next = 0;                              // first contig not yet written
+	bool writing = false;                      // a thread is flushing (guarded by mlock)
+	flush_call flush;
+
+	// As the writer: flush runs of finished contigs until none is waiting, then stop being the writer
+	void drain(std::unique_lock<std::mutex> &lock) {
+		const int n = done.size();
+		while (true) {
+			const int first = next;
+			int last = first;
+			while (last < n && done[last]) { last += 1; }
+			if (last == first) { break; }
+			lock.unlock();
+			for (int j = first; j < last; j++) { flush(j); }
+			lock.lock();
+			next = last;
+		}
+		writing = false;
+	}
+
+public:
+
+	/////////////////////////////////////////////////////////////
+	/* Constructors */
+
+	OrderedWriter(const int &contigs, flush_call t_flush) : done(contigs, false), flush(std::move(t_flush)) {}
+
+	/////////////////////////////////////////////////////////////
+	/* Writer Functions */
+
+	// Contig i is finished; write it (and any finished contigs after it) if every contig before it is written
+	void complete(const int &i) {
+		std::unique_lock<std::mutex> lock(mlock);
+		done[i] = true;
+		if (writing) { return; }
+		writing = true;
+		this -> drain(lock);
+	}
+
+	// Part of contig i is ready (--windowed): if every contig before it is written, write it now
+	//	through part (as the writer) and return true; else return false, and the caller keeps
+	//	it for flush(i)
+	bool write_part(const int &i, const part_call &part) {
+		std::unique_lock<std::mutex> lock(mlock);
+		if (writing || next != i) { return false; }
+		writing = true;
+		lock.unlock();
+		part();
+		lock.lock();
+		this -> drain(lock);
+		return true;
+	}
+
+	int written() {
+		std::unique_lock<std::mutex> lock(mlock);
+		return next;
+	}
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Point Spill Class
+	--max-memory: one budget for the points buffered by every contig task.
+	Each PointStore counts its bytes here once its node is complete (see
+	ClusterNode::settle_points); a store settled while the total is past the
+	budget is written to an unlinked temp file and released, then read back
+	when a later stage needs it. The file only ever grows, space is not reused.
+	Appends reserve their range atomically and use pwrite/pread, so contig
+	tasks spill and reload without holding a lock.
+*/
+
+class PointSpill {
+
+private:
+
+	static size_t budget;                          // bytes, 0 = never spill
+	static std::atomic<long long> resident;        // bytes counted by settled stores
+	static int fd;
+	static std::once_flag open_flag;
+	static std::atomic<uint64_t> file_end;
+
+	// Summary
+	static std::atomic<size_t> spills;
+	static std::atomic<size_t> reloads;
+	static std::atomic<long long> peak;
+
+	static void open();
+
+public:
+
+	static void set_budget(const size_t &bytes) { budget = bytes; }
+	static bool enabled() { return budget != 0; }
+	static bool over_budget() { return resident.load(std::memory_order_relaxed) > (long long)budget; }
+
+	// Settled stores growing, shrinking, leaving or coming back
+	static void adjust(const long long &bytes);
+
+	// Reserve n bytes at the end of the file (opened on first use), then fill them
+	static uint64_t reserve(const size_t &n);
+	static void write_at(const uint64_t &offset, const void *data, const size_t &n);
+	static void read_at(const uint64_t &offset, void *data, const size_t &n);
+	static void count_reload() { ++reloads; }
+
+	static void close();
+	static void print_stats(std::ostream &out);
+};
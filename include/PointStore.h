@@ -0,0 +1,289 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+#include "PointSpill.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Point Store Class
+	A node's points (the 5'/3' ends of each aligned block), packed:
+	  - positions are offsets from the node start, stored as 5',3' pairs,
+	    16 bits each until one does not fit, then every offset is widened
+	    to 32 bits (once)
+	  - read indexes are implied: read r owns points [end(r - 1), end(r))
+	  - weights are per read, and only stored once a duplicate has folded in
+	Points stay in read order; DBSCAN sorts a permutation, never the points.
+	visit() hands out the pair array itself, so hot loops compare offsets
+	directly and only add the base back to report coordinates.
+	Reads arrive in start order, so no point lies before the base.
+	Under --max-memory a settled store may be spilled (see PointSpill); its
+	arrays are then empty until load().
+*/
+
+class PointStore {
+
+private:
+
+	int base = 0;                              // node start, offsets are from here
+	bool wide = false;                         // offsets needed 32 bits
+	std::vector<uint16_t> pairs16;             // five, three, five, three, ...
+	std::vector<uint32_t> pairs32;
+	std::vector<uint32_t> ends;                // one past each read's last point
+	std::vector<uint32_t> weights;             // reads behind each stored read (empty = all 1)
+
+	// --max-memory
+	size_t settled = 0;                        // bytes counted against the budget
+	int64_t spill_offset = -1;                 // where the arrays went (-1 = resident)
+	uint32_t spill_pairs = 0, spill_ends = 0, spill_weights = 0;
+
+	void widen() {
+		pairs32.assign(pairs16.begin(), pairs16.end());
+		std::vector<uint16_t>().swap(pairs16);
+		wide = true;
+	}
+
+	void truncate(const size_t &n) {
+		if (wide) { pairs32.resize(2 * n); } else { pairs16.resize(2 * n); }
+	}
+
+public:
+
+	/////////////////////////////////////////////////////////////
+	/* Constructors */
+
+	PointStore() {}
+	PointStore(const int &t_base) { base = t_base; }
+	~PointStore() { this -> unsettle(); }
+
+	// Copies start uncounted; a move takes the count with it
+	PointStore(const PointStore &other) { *this = other; }
+	PointStore(PointStore &&other) noexcept { *this = std::move(other); }
+
+	PointStore& operator=(const PointStore &other) {
+		if (this == &other) { return *this; }
+		this -> unsettle();
+		base = other.base; wide = other.wide;
+		pairs16 = other.pairs16; pairs32 = other.pairs32;
+		ends = other.ends; weights = other.weights;
+		spill_offset = other.spill_offset;
+		spill_pairs = other.spill_pairs; spill_ends = other.spill_ends; spill_weights = other.spill_weights;
+		return *this;
+	}
+
+	PointStore& operator=(PointStore &&other) noexcept {
+		if (this == &other) { return *this; }
+		this -> unsettle();
+		base = other.base; wide = other.wide;
+		pairs16 = std::move(other.pairs16); pairs32 = std::move(other.pairs32);
+		ends = std::move(other.ends); weights = std::move(other.weights);
+		spill_offset = other.spill_offset;
+		spill_pairs = other.spill_pairs; spill_ends = other.spill_ends; spill_weights = other.spill_weights;
+		settled = other.settled;
+		other.settled = 0;
+		return *this;
+	}
+
+	/////////////////////////////////////////////////////////////
+	/* Get Functions */
+
+	int get_base() const { return base; }
+	bool is_wide() const { return wide; }
+	size_t size() const { return (wide ? pairs32.size() : pairs16.size()) / 2; }
+	size_t reads() const { return ends.size(); }
+
+	int five(const size_t &i) const { return base + (int)(wide ? pairs32[2 * i] : pairs16[2 * i]); }
+	int three(const size_t &i) const { return base + (int)(wide ? pairs32[2 * i + 1] : pairs16[2 * i + 1]); }
+
+	// Read r: its points and the reads folded into it
+	size_t read_begin(const size_t &r) const { return (r == 0) ? 0 : ends[r - 1]; }
+	size_t read_end(const size_t &r) const { return ends[r]; }
+	int read_weight(const size_t &r) const { return weights.empty() ? 1 : (int)weights[r]; }
+
+	// Points of the read being added (not yet closed)
+	size_t open_begin() const { return ends.empty() ? 0 : ends.back(); }
+
+	// Read owning point i
+	size_t read_of(const size_t &i) const { return std::upper_bound(ends.begin(), ends.end(), (uint32_t)i) - ends.begin(); }
+
+	// Weight of every point, in point order (empty while every weight is 1)
+	std::vector<int> point_weights() const {
+		std::vector<int> t_weights;
+		if (weights.empty()) { return t_weights; }
+		t_weights.reserve(this -> size());
+		const size_t n = ends.size();
+		for (size_t r = 0; r < n; r++) { t_weights.insert(t_weights.end(), read_end(r) - read_begin(r), weights[r]); }
+		return t_weights;
+	}
+
+	// f(pairs) on the raw offset pairs (uint16_t or uint32_t): point i is pairs[2i], pairs[2i + 1]
+	template <typename F>
+	auto visit(F &&f) const {
+		if (wide) { return f(pairs32.data()); }
+		return f(pairs16.data());
+	}
+
+	/////////////////////////////////////////////////////////////
+	/* Point Functions */
+
+	void push(const int &five, const int &three) {
+		const uint32_t t_five = five - base;
+		const uint32_t t_three = three - base;
+		if (!wide && (t_five > UINT16_MAX || t_three > UINT16_MAX)) { this -> widen(); }
+		if (wide) {
+			pairs32.push_back(t_five);
+			pairs32.push_back(t_three);
+		} else {
+			pairs16.push_back(t_five);
+			pairs16.push_back(t_three);
+		}
+	}
+
+	void close_read() {
+		ends.push_back(this -> size());
+		if (!weights.empty()) { weights.push_back(1); }
+	}
+
+	// Same points as another read
+	bool same_read(const size_t &a, const size_t &b) const {
+		const size_t a_first = read_begin(a), b_first = read_begin(b);
+		const size_t n = read_end(b) - b_first;
+		if (read_end(a) - a_first != n) { return false; }
+		for (size_t k = 0; k < n; k++) {
+			if (this -> five(a_first + k) != this -> five(b_first + k)) { return false; }
+			if (this -> three(a_first + k) != this -> three(b_first + k)) { return false; }
+		}
+		return true;
+	}
+
+	// Hash of a read's points (equal for reads same_read would match)
+	uint64_t read_hash(const size_t &r) const {
+		uint64_t h = 14695981039346656037ULL;
+		for (size_t k = read_begin(r); k < read_end(r); k++) {
+			h = (h ^ (uint32_t)this -> five(k)) * 1099511628211ULL;
+			h = (h ^ (uint32_t)this -> three(k)) * 1099511628211ULL;
+		}
+		return h;
+	}
+
+	// Drop the last read and count it on read r instead
+	void fold_last_into(const size_t &r) {
+		this -> truncate(this -> read_begin(ends.size() - 1));
+		ends.pop_back();
+		if (weights.empty()) { weights.assign(ends.size(), 1); } else { weights.pop_back(); }
+		weights[r] += 1;
+	}
+
+	// Append another store's reads after these (rebased onto this base)
+	void append(const PointStore &other) {
+
+		const size_t shift = this -> size();
+		const size_t n = other.size();
+		for (size_t i = 0; i < n; i++) { this -> push(other.five(i), other.three(i)); }
+
+		if (!weights.empty() || !other.weights.empty()) {
+			if (weights.empty()) { weights.assign(ends.size(), 1); }
+			if (other.weights.empty()) {
+				weights.insert(weights.end(), other.ends.size(), 1);
+			} else {
+				weights.insert(weights.end(), other.weights.begin(), other.weights.end());
+			}
+		}
+		for (const uint32_t end : other.ends) { ends.push_back(shift + end); }
+	}
+
+	// Drop spare capacity. Growth leaves at most half the capacity spare,
+	//	so only reallocate when more than that is (after folding or a merge).
+	void shrink() {
+		const size_t n = this -> size();
+		const size_t capacity = (wide ? pairs32.capacity() : pairs16.capacity()) / 2;
+		if (capacity <= 2 * n) { return; }
+		pairs16.shrink_to_fit(); pairs32.shrink_to_fit();
+		ends.shrink_to_fit(); weights.shrink_to_fit();
+	}
+
+	/////////////////////////////////////////////////////////////
+	/* Memory Budget Functions */
+
+	// Heap bytes held (capacity: what the allocator actually gave out)
+	size_t bytes() const {
+		return pairs16.capacity() * sizeof(uint16_t) + pairs32.capacity() * sizeof(uint32_t)
+		     + (ends.capacity() + weights.capacity()) * sizeof(uint32_t);
+	}
+	bool is_spilled() const { return spill_offset >= 0; }
+
+	// Count (or recount) this store against the budget
+	void settle() {
+		const size_t now = this -> bytes();
+		if (now != settled) { PointSpill::adjust((long long)now - (long long)settled); }
+		settled = now;
+	}
+	void unsettle() {
+		if (settled == 0) { return; }
+		PointSpill::adjust(-(long long)settled);
+		settled = 0;
+	}
+
+	// Write the arrays out and release them
+	void spill() {
+
+		if (this -> is_spilled() || ends.empty()) { return; }
+
+		spill_pairs = wide ? pairs32.size() : pairs16.size();
+		spill_ends = ends.size();
+		spill_weights = weights.size();
+
+		const size_t pair_bytes = wide ? spill_pairs * sizeof(uint32_t) : spill_pairs * sizeof(uint16_t);
+		const size_t run_bytes = (spill_ends + spill_weights) * sizeof(uint32_t);
+		const uint64_t offset = PointSpill::reserve(pair_bytes + run_bytes);
+
+		PointSpill::write_at(offset, wide ? (const void*)pairs32.data() : (const void*)pairs16.data(), pair_bytes);
+		PointSpill::write_at(offset + pair_bytes, ends.data(), spill_ends * sizeof(uint32_t));
+		PointSpill::write_at(offset + pair_bytes + spill_ends * sizeof(uint32_t), weights.data(), spill_weights * sizeof(uint32_t));
+
+		std::vector<uint16_t>().swap(pairs16);
+		std::vector<uint32_t>().swap(pairs32);
+		std::vector<uint32_t>().swap(ends);
+		std::vector<uint32_t>().swap(weights);
+		this -> unsettle();
+		spill_offset = offset;
+	}
+
+	// Read spilled arrays back (uncounted until settled again)
+	void load() {
+
+		if (!this -> is_spilled()) { return; }
+
+		size_t pair_bytes;
+		if (wide) {
+			pairs32.resize(spill_pairs);
+			pair_bytes = spill_pairs * sizeof(uint32_t);
+			PointSpill::read_at(spill_offset, pairs32.data(), pair_bytes);
+		} else {
+			pairs16.resize(spill_pairs);
+			pair_bytes = spill_pairs * sizeof(uint16_t);
+			PointSpill::read_at(spill_offset, pairs16.data(), pair_bytes);
+		}
+		ends.resize(spill_ends);
+		weights.resize(spill_weights);
+		PointSpill::read_at(spill_offset + pair_bytes, ends.data(), spill_ends * sizeof(uint32_t));
+		PointSpill::read_at(spill_offset + pair_bytes + spill_ends * sizeof(uint32_t), weights.data(), spill_weights * sizeof(uint32_t));
+
+		spill_offset = -1;
+		PointSpill::count_reload();
+	}
+
+	// Release everything (base is kept)
+	void clear() {
+		std::vector<uint16_t>().swap(pairs16);
+		std::vector<uint32_t>().swap(pairs32);
+		std::vector<uint32_t>().swap(ends);
+		std::vector<uint32_t>().swap(weights);
+		wide = false;
+		spill_offset = -1;
+		this -> unsettle();
+	}
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Read Ahead Class
+	Uses the BAI to find the compressed byte range of each contig. Before a
+	contig (or tile) is read, its range is advised WILLNEED, so the kernel reads
+	it ahead into the page cache that every contig task shares. Decoding still
+	goes through AlignmentReader; its reads are then served from the page cache.
+*/
+
+class ReadAhead {
+
+private:
+
+	// Compressed bytes of one contig, plus the linear index (16 kb windows -> file offset)
+	struct ContigRange {
+		uint64_t start = UINT64_MAX;
+		uint64_t stop = 0;
+		std::vector<uint64_t> windows;
+	};
+
+	int fd = -1;
+	uint64_t file_size = 0;
+	std::vector<ContigRange> ranges;
+	mutable std::atomic<bool> advised_all{false};   // the whole file is only advised once
+
+	bool parse_index(const std::vector<unsigned char> &bai);
+	void advise(uint64_t start, uint64_t stop) const;
+
+public:
+
+	/////////////////////////////////////////////////////////////
+	/* Constructors */
+
+	ReadAhead() {}
+	~ReadAhead() { this -> close(); }
+
+	ReadAhead(const ReadAhead&) = delete;
+	ReadAhead& operator=(const ReadAhead&) = delete;
+
+	/////////////////////////////////////////////////////////////
+	/* File Functions */
+
+	// Index is optional (streaming); without it only whole-file hints are given
+	bool open(const std::string &bam_name, const std::string &bai_name);
+	void close();
+	bool is_open() const { return fd >= 0; }
+
+	/////////////////////////////////////////////////////////////
+	/* Get Functions */
+
+	// Contigs with a byte range (0 without a parsed BAI); a contig without reads has start >= stop
+	size_t indexed_contigs() const { return ranges.size(); }
+	uint64_t contig_start(const int &contig_index) const { return ranges[contig_index].start; }
+	uint64_t contig_stop(const int &contig_index) const { return ranges[contig_index].stop; }
+
+	/////////////////////////////////////////////////////////////
+	/* Read-Ahead Hints */
+
+	// Contig (or tile: t_start up to t_stop, -1 = contig edge) about to be read
+	void advise_contig(const int &contig_index, const int &t_start = -1, const int &t_stop = -1) const;
+	void advise_all() const;
+};
@@ -1,95 +0,0 @@
-#include <functional>
-#include <cstdint>
-#include <queue>
-
-// Special thanks to https://github.com/embeddedartistry/embedded-resources/blob/master/examples/cpp/dispatch.cpp
-//	for the code inspiration :)
-
-extern bool MAIN_THREAD;
-
-//////////////////////////////////////
-// Thread safe dispatch queue
-class thread_queue {
-
-	typedef std::function<void(void)> call;
-
-public:
-
-	std::mutex mlock;
-	std::vector<std::thread> threads;
-	std::queue<call> call_queue;
-	std::condition_variable cv;
-	bool quit = false;
-
-	thread_queue(size_t thread_cnt) : threads(thread_cnt) {
-		for (size_t i = 0; i < threads.size(); i++) {
-			threads[i] = std::thread(&thread_queue::thread_handler, this);
-		}
-	}
-
-	~thread_queue() {
-
-		// creat lock and set quit to true
-		std::unique_lock<std::mutex> lock(mlock);
-		quit = true;
-
-		// unlock, notify all threads
-		cv.notify_all();
-		lock.unlock();
-
-		for (auto &t : threads) {
-			if (t.joinable()) {
-				t.join();
-			}
-		}
-		::MAIN_THREAD = true;
-	}
-
-	// dispatch (basically enqueue)
-	void dispatch(call job) {
-		std::unique_lock<std::mutex> lock(mlock);    // create lock
-		call_queue.push(std::move(job));             // enqueue (job is a non-const value, so this moves)
-		cv.notify_one();                             // notify conditional var
-	}
-
-	// thread handler
-	void thread_handler(void) {
-
-		std::unique_lock<std::mutex> lock(mlock); // create lock
-
-		do {
-			// wait for data (still need to think about this one)
-			cv.wait(lock, [this] {
-				return (call_queue.size() || quit);
-			});
-
-			// Drain every queued job before honoring quit. Previously this ran a
-			// single job only when !quit, so any job still queued when the
-			// destructor set quit was silently dropped -- its launch() never ran
-			// and that contig's ClusterList was never built (null-deref at write
-			// time, surfaced under -O3). Draining guarantees submitted work runs.
-			while (call_queue.size()) {
-
-				// create job
-				auto job = std::move(call_queue.front());
-				call_queue.pop();
-
-				lock.unlock();       // unlock now that we're done messing with the queue
-				job();               // call job
-				lock.lock();         // lock
-			}
-		} while (!quit);
-
-	}
-
-	// Lock when reading shared state: an unlocked empty() read races with the
-	// workers popping the queue (the main-thread drain loop spins on this).
-	bool finished() {
-		std::unique_lock<std::mutex> lock(mlock);
-		return call_queue.empty();
-	}
-	int size() {
-		std::unique_lock<std::mutex> lock(mlock);
-		return call_queue.size();
-	}
-};
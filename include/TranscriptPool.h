@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Transcript Pool Class
+	Exon bounds of every transcript found on a contig, back to back in one
+	vector. A node keeps a TranscriptSpan (offset, length) per transcript
+	rather than a vector of its own, so reporting a transcript is an append
+	and writing them out is a linear scan. Spans dropped when neighbouring
+	nodes' transcripts are merged are simply left behind; the pool goes with
+	the contig's ClusterList.
+	Gene assignments are ordinals into the pool's gene IDs, each ID stored
+	once however many transcripts it takes.
+*/
+
+// Transcript i of a node: exons[offset, offset + length) in its pool (start, stop, start, stop, ...)
+struct TranscriptSpan {
+	uint32_t offset = 0;
+	uint32_t length = 0;
+};
+
+// Read-only view of one transcript's bounds (stays valid until the pool grows)
+class ExonSpan {
+
+private:
+
+	const int *first = nullptr;
+	int n = 0;
+
+public:
+
+	ExonSpan() {}
+	ExonSpan(const int *t_first, const int t_n) : first(t_first), n(t_n) {}
+	ExonSpan(const std::vector<int> &vec) : first(vec.data()), n(vec.size()) {}
+
+	int size() const { return n; }
+	bool empty() const { return n == 0; }
+	const int& operator[](const int &i) const { return first[i]; }
+	const int& front() const { return first[0]; }
+	const int& back() const { return first[n - 1]; }
+	const int* begin() const { return first; }
+	const int* end() const { return first + n; }
+};
+
+class TranscriptPool {
+
+private:
+
+	std::vector<int> exons;
+	std::vector<std::string> gene_ids;
+
+public:
+
+	// Assignments other than a gene
+	static constexpr int unassigned = -1;
+	static constexpr int ambiguous = -2;
+
+	/////////////////////////////////////////////////////////////
+	/* Get Functions */
+
+	size_t size() const { return exons.size(); }
+	ExonSpan get(const TranscriptSpan &span) const { return ExonSpan(exons.data() + span.offset, span.length); }
+
+	const std::string& gene_name(const int &ordinal) const {
+		static const std::string t_unassigned = "Unassigned";
+		static const std::string t_ambiguous = "Ambiguous";
+		if (ordinal == ambiguous) { return t_ambiguous; }
+		if (ordinal < 0 || ordinal >= (int)gene_ids.size()) { return t_unassigned; }
+		return gene_ids[ordinal];
+	}
+
+	/////////////////////////////////////////////////////////////
+	/* Pool Functions */
+
+	TranscriptSpan add(const ExonSpan &transcript) {
+		TranscriptSpan span;
+		span.offset = exons.size();
+		span.length = transcript.size();
+		exons.insert(exons.end(), transcript.begin(), transcript.end());
+		return span;
+	}
+
+	// Transcripts are assigned in position order, so a gene's transcripts come one after another
+	int gene_ordinal(const std::string &gene_id) {
+		if (gene_ids.empty() || gene_ids.back() != gene_id) { gene_ids.push_back(gene_id); }
+		return gene_ids.size() - 1;
+	}
+
+	// Move another pool's exons onto the end of this one, returns the offset its spans move by.
+	//	Tiles are stitched before genes are assigned, so there are no gene IDs to carry.
+	uint32_t append(TranscriptPool &other) {
+		const uint32_t shift = exons.size();
+		if (exons.empty()) {
+			exons.swap(other.exons);
+		} else {
+			exons.insert(exons.end(), other.exons.begin(), other.exons.end());
+		}
+		std::vector<int>().swap(other.exons);
+		return shift;
+	}
+};
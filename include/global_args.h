@@ -32,6 +32,20 @@ struct GlobalArgs {
 
     // Output
     std::string gtf_output;             // name of output gtf file
+
+    // Decoding
+    int bgzf_threads;                   // BGZF decompression threads (htslib builds)
+    int tile_size;                      // split contigs longer than this into parallel tiles (0 = off)
+    bool stream;                        // single pass over the BAM, no index
+    int ring_size;                      // records buffered between decoder and clustering threads (0 = inline)
+    bool readahead;                     // hint the kernel to read each contig ahead
+
+    // Memory
+    int max_memory;                     // MB of buffered read points before spilling to disk (0 = no limit)
+    bool windowed;                      // finish each locus once the reads have moved past it
+
+    // DBSCAN
+    std::string dbscan_kernel;          // "linear" (or empty) or "scan" (per-point neighbor scans, for validation)
 };
 
 extern GlobalArgs Args;
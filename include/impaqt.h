@@ -1,9 +1,13 @@
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <sstream>
 #include <unordered_map>
 #include <stdexcept>
-#include <api/BamAux.h>
-#include <api/BamReader.h>
 
+#include "AlignmentReader.h"
+#include "ReadAhead.h"
+#include "OrderedWriter.h"
 #include "AnnotationList.h"
 #include "ClusterList.h"
 #include "DBSCAN.h"
@@ -17,14 +21,20 @@ class Impaqt {
 private:
 
 	// Alignment file Readers
-	BamTools::BamReader inFile;
-	BamTools::BamAlignment alignment;
+	AlignmentReader inFile;
+	AlignmentRecord alignment;
 
 	// Files and Data Structure
 	std::unique_ptr<ClusterList> cluster_list;
+	std::vector<std::unique_ptr<ClusterList>> tile_lists;    // one per tile, stitched into cluster_list
+	std::atomic<int> tiles_remaining{0};
+	std::ostringstream finished_gtf;                         // --windowed: finished loci held until earlier contigs are written
+	OrderedWriter *writer = nullptr;                         // --windowed: where finished loci go (see finish_window)
+	std::ostream *output = nullptr;
 	static AnnotationList annotation;
 	static std::string alignment_file_name;
 	static std::string index_file_name;
+	static ReadAhead read_ahead;
 	static std::unordered_map<int, std::string> contig_map;
 	static std::unordered_map<int, int> contig_lengths;
 	
@@ -75,6 +85,7 @@ public:
 
 	// Get Data Structures
 	AnnotationList* get_annotation() { return &annotation; }
+	AlignmentReader& get_alignment_file() { return inFile; }
 	ClusterList* get_clusters() { return cluster_list.get(); }
 
 	// Get Chromosome Info
@@ -89,26 +100,39 @@ public:
 	/////////////////////////////////////////////////////////////
 	/* Thread Initilizers */
 
-	void open_alignment_file() {
-		if (!inFile.Open(alignment_file_name)) {
+	static void open_alignment_file(AlignmentReader &reader) {
+		if (!reader.open(alignment_file_name)) {
 			std::cerr << "ERROR: Could not read alignment file: " << alignment_file_name << "\n";
 			throw std::runtime_error("ERROR: Make sure alignment file exists.");
 		}
-		if (!inFile.OpenIndex(index_file_name)) {
+		if (ImpaqtArguments::Args.stream) { return; } // read front to back, never jumps
+		if (!reader.open_index(index_file_name)) {
 			std::cerr << "ERROR: Could not read index file: " << index_file_name << "\n";
 			throw std::runtime_error("ERROR: Make sure index is present in BAM file location.");
 		}
 	}
 
-	void close_alignment_file() { inFile.Close(); }
+	void open_alignment_file() { open_alignment_file(inFile); }
+
+	// --readahead: hints only, decoding still goes through AlignmentReader
+	static void open_read_ahead() {
+		const std::string index_name = ImpaqtArguments::Args.stream ? "" : index_file_name;
+		if (!read_ahead.open(alignment_file_name, index_name)) {
+			std::cerr << "// NOTICE: Could not open " << alignment_file_name << "; reading without read-ahead hints.\n";
+			return;
+		}
+		if (ImpaqtArguments::Args.stream) { read_ahead.advise_all(); } // one pass, front to back
+	}
+
+	static void close_read_ahead() { read_ahead.close(); }
+
+	void close_alignment_file() { inFile.close(); }
 
 	// Parse input file for contig order and jump positions
 	void set_chrom_order() {
 
-		BamTools::SamHeader head = inFile.GetHeader();
-
-		if (head.HasSortOrder()) {
-			std::string sortOrder = head.SortOrder;
+		if (inFile.has_sort_order()) {
+			const std::string &sortOrder = inFile.get_sort_order();
 			if (sortOrder.compare("coordinate") != 0) {
 				std::cerr << "ERROR: Sorted alignment file required.\n";
 				throw std::runtime_error("ERROR: Could not read alignment file.");
@@ -119,10 +143,11 @@ public:
 		}
 
 		// Generate Contig Map (contig indicies -> contig name)
-		BamTools::RefVector references = inFile.GetReferenceData();
-		for (int i = 0; i < references.size(); i++) {
-			contig_map[i] = references.at(i).RefName;
-			contig_lengths[i] = references.at(i).RefLength;
+		const std::vector<ContigInfo> &references = inFile.get_references();
+		const int n = references.size();
+		for (int i = 0; i < n; i++) {
+			contig_map[i] = references.at(i).name;
+			contig_lengths[i] = references.at(i).length;
 		}
 	}
 
@@ -131,27 +156,115 @@ public:
 		contig_length = contig_lengths[contig_index];
 	}
 
+	// Number of tiles this contig is split into (1 = whole contig, see launch_tile)
+	int init_tiles() {
+		const int tile_size = ImpaqtArguments::Args.tile_size;
+		const int length = contig_lengths[contig_index];
+		int tiles = 1;
+		if (tile_size > 0 && length > tile_size && !ImpaqtArguments::Args.windowed) { tiles = ((int64_t)length + tile_size - 1) / tile_size; }
+		tile_lists.clear();
+		tile_lists.resize(tiles);
+		tiles_remaining = tiles;
+		if (tiles > 1) { this -> set_contigs(); } // once, before tiles share this process
+		return tiles;
+	}
+
 	void add_annotation() {
 		annotation = AnnotationList();
 		annotation.create_gene_list();
+		annotation.set_contig_ids(contig_map);
 	}
 
 	/////////////////////////////////////////////////////////////
 	/* Cluster Related Functions */
 
-	void create_clusters() {
-
-		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
-
-		if (!inFile.Jump(contig_index)) {
+	// Position the reader on this contig's first record
+	void jump_to_contig() {
+		read_ahead.advise_contig(contig_index);
+		if (!inFile.jump(contig_index)) {
 			std::cerr << "//ERROR: Could not jump to region: " << contig_name << "\n";
 			throw std::runtime_error("ERROR: Could not jump to region. Make sure BAM header is correct.");
 		}
+		inFile.start_pipeline(ImpaqtArguments::Args.ring_size, contig_index);
+	}
+
+	void create_clusters() {
+
+		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+		this -> jump_to_contig();
 
 		// If failed to create clusters, flag to ignore
 		if (!(cluster_list -> create_clusters(inFile, alignment))) { ignore = true; }
 	}
 
+	// Streaming: fill this contig from a reader shared by every contig, in file order.
+	//	The reader is left holding the first record of the next contig.
+	void stream_clusters(AlignmentReader &reader) {
+		this -> set_contigs();
+		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+		if (!(cluster_list -> create_clusters(reader, alignment))) { ignore = true; }
+	}
+
+	// Streaming and --windowed: the contig is finished on the reading thread as it goes
+	void stream_windows(AlignmentReader &reader) {
+		this -> set_contigs();
+		this -> window_clusters(reader);
+	}
+
+	/*
+	  --windowed: read the contig one batch at a time (see ClusterList::create_clusters).
+	  Each batch is collapsed and clustered on its own, as a tile would be, then
+	  joins the nodes still waiting on transcript collapse. Those are finished
+	  (collapsed, assigned, written out and freed) once no transcript among them
+	  reaches the next batch, as nothing read later can collapse into them.
+	*/
+	void window_clusters(AlignmentReader &reader) {
+
+		size_t passing_reads = 0;
+		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+
+		while (true) {
+
+			std::unique_ptr<ClusterList> batch = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+			batch -> set_windowed();
+
+			if (batch -> create_clusters(reader, alignment)) {
+				int t_strand = 0; // Forward
+				batch -> collapse_clusters(t_strand);
+				batch -> collapse_clusters(!t_strand);
+				identify_transcripts_dbscan(batch.get(), t_strand);
+				identify_transcripts_dbscan(batch.get(), !t_strand);
+			}
+			cluster_list -> append_list(batch.get());
+
+			const int cut = batch -> get_cut();
+			if (cut == -1 || cluster_list -> get_transcript_stop() < cut) {
+				passing_reads += cluster_list -> get_passing_reads(0) + cluster_list -> get_passing_reads(1);
+				this -> finish_window();
+			}
+			if (cut == -1) { break; }
+		}
+
+		// Same as a failed create_clusters on the whole contig
+		ignore = (passing_reads == 0);
+	}
+
+	// Collapse, assign and write the waiting nodes, then start an empty list
+	void finish_window() {
+		if (cluster_list -> get_passing_reads(0) + cluster_list -> get_passing_reads(1) != 0) {
+			this -> collapse_transcripts();
+			if (ImpaqtArguments::Args.annotation_file != "") {
+				this -> assign_transcripts();
+			}
+		}
+		// Written at once if every earlier contig is, else held until they are
+		if (writer == nullptr || !writer -> write_part(contig_index, [&] { this -> write_finished(*output); })) {
+			cluster_list -> write_clusters_as_GTF(finished_gtf);
+		}
+		this -> get_stats();
+		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+	}
+
 	void collapse_clusters() {
 		int t_strand = 0; // Forward
 		cluster_list -> collapse_clusters(t_strand);
@@ -165,38 +278,138 @@ public:
 		identify_transcripts(cluster_list.get(), !t_strand);
 	}
 
+	void collapse_transcripts() {
+		if (ignore) { return; }
+		int t_strand = 0; // Forward
+		::collapse_transcripts(cluster_list.get(), t_strand);
+		::collapse_transcripts(cluster_list.get(), !t_strand);
+	}
+
 	void assign_transcripts() {
 		int t_strand = 0; // Forward
-		assign_to_genes(annotation, cluster_list.get(), contig_name, t_strand);
-		assign_to_genes(annotation, cluster_list.get(), contig_name, !t_strand);
+		assign_to_genes(annotation, cluster_list.get(), t_strand);
+		assign_to_genes(annotation, cluster_list.get(), !t_strand);
 	}
 
 	/////////////////////////////////////////////////////////////
 	/* Output Functions */
 
-	void write_gtf(std::ofstream &gtfFile) {
+	// Finished contig's output (in contig order, see OrderedWriter)
+	void set_output(OrderedWriter *t_writer, std::ostream *t_output) {
+		writer = t_writer;
+		output = t_output;
+	}
+
+	void write_gtf(std::ostream &gtfFile) {
 		if (ignore) { return; }
+		this -> write_finished(gtfFile);
+	}
+
+	// Held loci first, then the current list
+	void write_finished(std::ostream &gtfFile) {
+		if (finished_gtf.tellp() > 0) {
+			gtfFile << finished_gtf.str();
+			std::ostringstream().swap(finished_gtf);
+		}
 		cluster_list -> write_clusters_as_GTF(gtfFile);
 	}
 
+	// Drop the contig's clusters once written (counts are kept)
+	void release_clusters() {
+		cluster_list.reset();
+		tile_lists.clear();
+		std::ostringstream().swap(finished_gtf);
+	}
+
+	// Add the list's counts (--windowed adds each finished window's)
 	void get_stats() {
-		assigned_reads = cluster_list -> get_assigned_reads();
-		unassigned_reads = cluster_list -> get_unassigned_reads();
-		ambiguous_reads = cluster_list -> get_ambiguous_reads();
-		multimapped_reads = cluster_list -> get_multimapped_reads();
-		low_quality_reads = cluster_list -> get_low_quality_reads();
-		total_reads = cluster_list -> get_total_reads();
-		transcript_num = cluster_list -> get_transcript_num();
+		assigned_reads += cluster_list -> get_assigned_reads();
+		unassigned_reads += cluster_list -> get_unassigned_reads();
+		ambiguous_reads += cluster_list -> get_ambiguous_reads();
+		multimapped_reads += cluster_list -> get_multimapped_reads();
+		low_quality_reads += cluster_list -> get_low_quality_reads();
+		total_reads += cluster_list -> get_total_reads();
+		transcript_num += cluster_list -> get_transcript_num();
 	}
 
 	/////////////////////////////////////////////////////////////
-	/* Thread Launcher */
+	/* Thread Launchers */
+
+	// Cluster one tile of the contig on its own reader. Everything up to and
+	//	including DBSCAN is local to a node, so it runs per tile; the last
+	//	tile to finish stitches the lists back together and does the rest
+	//	(and returns true: the contig is done).
+	bool launch_tile(const int &tile) {
+
+		const int tiles = tile_lists.size();
+		const int tile_size = ImpaqtArguments::Args.tile_size;
+		// In 64 bits: tile_size near INT_MAX would overflow the products
+		const int t_start = (tile == 0) ? -1 : (int)((int64_t)tile * tile_size);
+		const int t_stop = (tile == tiles - 1) ? -1 : (int)((int64_t)(tile + 1) * tile_size);
+
+		std::unique_ptr<ClusterList> t_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+		t_list -> set_tile(t_start, t_stop);
+
+		AlignmentReader tile_file;
+		AlignmentRecord tile_alignment;
+		open_alignment_file(tile_file);
+		read_ahead.advise_contig(contig_index, t_start, t_stop);
+		if (!tile_file.jump(contig_index, std::max(t_start, 0))) {
+			std::cerr << "//ERROR: Could not jump to region: " << contig_name << ":" << t_start << "\n";
+			throw std::runtime_error("ERROR: Could not jump to region. Make sure BAM header is correct.");
+		}
+		tile_file.start_pipeline(ImpaqtArguments::Args.ring_size, contig_index);
+
+		if (t_list -> create_clusters(tile_file, tile_alignment)) {
+			int t_strand = 0; // Forward
+			t_list -> collapse_clusters(t_strand);
+			t_list -> collapse_clusters(!t_strand);
+			identify_transcripts_dbscan(t_list.get(), t_strand);
+			identify_transcripts_dbscan(t_list.get(), !t_strand);
+		}
+		tile_file.close();
+
+		tile_lists[tile] = std::move(t_list);
+		if (--tiles_remaining != 0) { return false; }
+		this -> finish_tiles();
+		return true;
+	}
+
+	// Stitch tiles in order, then collapse transcripts across tile boundaries
+	void finish_tiles() {
+
+		cluster_list = std::make_unique<ClusterList>(contig_index, contig_name, contig_length);
+		for (auto &t_list : tile_lists) { cluster_list -> append_list(t_list.get()); }
+		tile_lists.clear();
+
+		// Same as a failed create_clusters on the whole contig
+		ignore = (cluster_list -> get_passing_reads(0) + cluster_list -> get_passing_reads(1) == 0);
+
+		if (!ignore) {
+			this -> collapse_transcripts();
+			if (ImpaqtArguments::Args.annotation_file != "") {
+				this -> assign_transcripts();
+			}
+		}
+		this -> get_stats();
+	}
 
 	void launch() {
 		this -> set_contigs();
 		this -> open_alignment_file();
+		if (ImpaqtArguments::Args.windowed) {
+			this -> jump_to_contig();
+			this -> window_clusters(inFile);
+			this -> close_alignment_file();
+			return;
+		}
 		this -> create_clusters();
 		this -> close_alignment_file();
+		this -> process_clusters();
+	}
+
+	// Everything after reading, for a contig whose clusters are already built
+	void process_clusters() {
 		if (!ignore) {
 			this -> collapse_clusters();
 			this -> find_transcripts();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Utils (alot of these could be more generalized...)
 
@@ -35,5 +37,11 @@ bool check_containment_strict(const std::vector<int> &b, const std::vector<int>
 // For Debugging
 void print_transcripts(const std::vector<std::vector<int>> &transcripts);
 
+// Sort (key << 32 | payload) pairs by key, equal keys in payload order (LSD radix; tmp is scratch)
+void radix_sort_pairs(std::vector<uint64_t> &pairs, std::vector<uint64_t> &tmp);
+
 // Check if file exists
-bool file_exists(const std::string& filename);
\ No newline at end of file
+bool file_exists(const std::string& filename);
+
+// Check if file is a pipe ("-", a FIFO or a character device such as /dev/stdin)
+bool is_pipe(const std::string& filename);
\ No newline at end of file
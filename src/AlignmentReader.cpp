@@ -0,0 +1,314 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AlignmentReader.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Alignment Reader Methods */
+
+#ifdef IMPAQT_USE_HTSLIB
+
+#include <htslib/kstring.h>
+
+// Static Member Defintions
+hts_tpool *AlignmentReader::decode_pool = nullptr;
+htsThreadPool AlignmentReader::shared_pool = {nullptr, 0};
+
+/////////////////////////////////////////////////////////////
+/* Decompression Thread Pool */
+
+// One pool for the whole run; each open file queues its BGZF blocks onto it
+void AlignmentReader::init_thread_pool(const int &threads) {
+	if (threads <= 0 || decode_pool != nullptr) { return; }
+	decode_pool = hts_tpool_init(threads);
+	shared_pool.pool = decode_pool;
+}
+
+// Only call once every reader is closed
+void AlignmentReader::destroy_thread_pool() {
+	if (decode_pool == nullptr) { return; }
+	hts_tpool_destroy(decode_pool);
+	decode_pool = nullptr;
+	shared_pool.pool = nullptr;
+}
+
+/////////////////////////////////////////////////////////////
+/* File Functions */
+
+void AlignmentReader::read_header() {
+
+	kstring_t so = KS_INITIALIZE;
+	sort_order.clear();
+	if (sam_hdr_find_tag_hd(header, "SO", &so) == 0) { sort_order = so.s; }
+	ks_free(&so);
+
+	const int n = sam_hdr_nref(header);
+	references.clear();
+	references.reserve(n);
+	for (int i = 0; i < n; i++) {
+		references.push_back({sam_hdr_tid2name(header, i), (int)sam_hdr_tid2len(header, i)});
+	}
+}
+
+bool AlignmentReader::open(const std::string &t_file_name) {
+
+	this -> close();
+	file_name = t_file_name;
+	in_file = sam_open(file_name.c_str(), "r");
+	if (in_file == nullptr) { return false; }
+
+	header = sam_hdr_read(in_file);
+	if (header == nullptr) { this -> close(); return false; }
+
+	// Attach to shared pool (if any) so inflation happens off this thread
+	if (decode_pool != nullptr) { hts_set_thread_pool(in_file, &shared_pool); }
+
+	record = bam_init1();
+	this -> read_header();
+	return true;
+}
+
+bool AlignmentReader::open_index(const std::string &index_name) {
+	if (in_file == nullptr) { return false; }
+	index = sam_index_load2(in_file, file_name.c_str(), index_name.c_str());
+	return index != nullptr;
+}
+
+bool AlignmentReader::jump(const int &contig_index, const int &position) {
+	this -> stop_pipeline();
+	if (index == nullptr) { return false; }
+	if (iter != nullptr) { hts_itr_destroy(iter); }
+	held = false;
+	iter = sam_itr_queryi(index, contig_index, position, HTS_POS_MAX);
+	return iter != nullptr;
+}
+
+void AlignmentReader::close() {
+	this -> stop_pipeline();
+	held = false;
+	if (iter != nullptr) { hts_itr_destroy(iter); iter = nullptr; }
+	if (index != nullptr) { hts_idx_destroy(index); index = nullptr; }
+	if (record != nullptr) { bam_destroy1(record); record = nullptr; }
+	if (header != nullptr) { sam_hdr_destroy(header); header = nullptr; }
+	if (in_file != nullptr) { sam_close(in_file); in_file = nullptr; }
+}
+
+/////////////////////////////////////////////////////////////
+/* Record Functions */
+
+bool AlignmentReader::decode_core(AlignmentRecord &alignment) {
+
+	// Iterator stops at the end of the jumped contig, plain read runs to EOF
+	if (held) {
+		held = false;
+	} else {
+		int ret;
+		if (iter != nullptr) {
+			ret = sam_itr_next(in_file, iter, record);
+		} else {
+			ret = sam_read1(in_file, header, record);
+		}
+		if (ret < 0) { return false; }
+	}
+
+	alignment.ref_id = record -> core.tid;
+	alignment.position = record -> core.pos;
+	alignment.flag = record -> core.flag;
+	alignment.mapq = record -> core.qual;
+	return true;
+}
+
+// Walks the aux block in place, nothing else in the variable-length data is touched
+void AlignmentReader::decode_nh(AlignmentRecord &alignment) {
+	const uint8_t *nh = bam_aux_get(record, "NH");
+	alignment.nh = (nh != nullptr) ? (int)bam_aux2i(nh) : 1;
+}
+
+void AlignmentReader::decode_cigar(AlignmentRecord &alignment) {
+	const uint32_t *cigar = bam_get_cigar(record);
+	const int n = record -> core.n_cigar;
+	alignment.cigar.clear();
+	for (int i = 0; i < n; i++) {
+		alignment.cigar.push_back({bam_cigar_opchr(cigar[i]), (int)bam_cigar_oplen(cigar[i])});
+	}
+}
+
+#else
+
+/////////////////////////////////////////////////////////////
+/* Decompression Thread Pool (bamtools inflates on the reading thread) */
+
+void AlignmentReader::init_thread_pool(const int &threads) { (void)threads; }
+void AlignmentReader::destroy_thread_pool() {}
+
+/////////////////////////////////////////////////////////////
+/* File Functions */
+
+void AlignmentReader::read_header() {
+
+	BamTools::SamHeader head = in_file.GetHeader();
+	sort_order.clear();
+	if (head.HasSortOrder()) { sort_order = head.SortOrder; }
+
+	BamTools::RefVector refs = in_file.GetReferenceData();
+	const int n = refs.size();
+	references.clear();
+	references.reserve(n);
+	for (int i = 0; i < n; i++) {
+		references.push_back({refs.at(i).RefName, (int)refs.at(i).RefLength});
+	}
+}
+
+bool AlignmentReader::open(const std::string &t_file_name) {
+	file_name = t_file_name;
+	if (!in_file.Open(file_name)) { return false; }
+	this -> read_header();
+	return true;
+}
+
+bool AlignmentReader::open_index(const std::string &index_name) { return in_file.OpenIndex(index_name); }
+bool AlignmentReader::jump(const int &contig_index, const int &position) {
+	this -> stop_pipeline();
+	held = false;
+	return in_file.Jump(contig_index, position);
+}
+
+void AlignmentReader::close() {
+	this -> stop_pipeline();
+	held = false;
+	in_file.Close();
+}
+
+/////////////////////////////////////////////////////////////
+/* Record Functions */
+
+// GetNextAlignmentCore leaves name, bases, qualities and tags undecoded (CigarData is core)
+bool AlignmentReader::decode_core(AlignmentRecord &alignment) {
+
+	if (held) {
+		held = false;
+	} else {
+		if (!in_file.GetNextAlignmentCore(record)) { return false; }
+		char_data = false;
+	}
+
+	alignment.ref_id = record.RefID;
+	alignment.position = record.Position;
+	alignment.flag = record.AlignmentFlag;
+	alignment.mapq = record.MapQuality;
+	return true;
+}
+
+// bamtools only exposes tags once the character data is built, so pay for it here and only here
+void AlignmentReader::decode_nh(AlignmentRecord &alignment) {
+	if (!char_data) { record.BuildCharData(); char_data = true; }
+
+	uint16_t nh;
+	alignment.nh = record.GetTag("NH", nh) ? (int)nh : 1;
+}
+
+void AlignmentReader::decode_cigar(AlignmentRecord &alignment) {
+	alignment.cigar.clear();
+	for (const auto &op : record.CigarData) {
+		alignment.cigar.push_back({op.Type, (int)op.Length});
+	}
+}
+
+#endif
+
+
+/////////////////////////////////////////////////////////////
+/* Record Functions (either backend) */
+
+bool AlignmentReader::get_next_core(AlignmentRecord &alignment) {
+	if (ring != nullptr) { return this -> next_from_ring(alignment); }
+	return this -> decode_core(alignment);
+}
+
+bool AlignmentReader::get_next_alignment(AlignmentRecord &alignment) {
+	if (!this -> get_next_core(alignment)) { return false; }
+	this -> load_nh(alignment);
+	this -> load_cigar(alignment);
+	return true;
+}
+
+
+/////////////////////////////////////////////////////////////
+/* Pipelined Decoding */
+
+// Static Member Defintions
+std::atomic<size_t> AlignmentReader::total_pops{0};
+std::atomic<size_t> AlignmentReader::total_fill{0};
+std::atomic<size_t> AlignmentReader::total_empty_waits{0};
+std::atomic<size_t> AlignmentReader::total_full_waits{0};
+std::atomic<size_t> AlignmentReader::ring_capacity{0};
+
+// The slot handed out last stays reserved until the next read, so hold() can copy it again
+bool AlignmentReader::next_from_ring(AlignmentRecord &alignment) {
+
+	if (ring_held && ring_record != nullptr) {
+		ring_held = false;
+		alignment = *ring_record;
+		return true;
+	}
+
+	if (ring_record != nullptr) { ring -> release(); }
+	ring_record = ring -> read_slot();
+	if (ring_record == nullptr) { return false; }
+
+	alignment = *ring_record;
+	return true;
+}
+
+void AlignmentReader::start_pipeline(const int &capacity, const int &contig_index) {
+
+	this -> stop_pipeline();
+	if (capacity <= 0) { return; }
+
+	ring = std::make_unique<AlignmentRing>(capacity);
+	ring_capacity = ring -> capacity();
+
+	// Decoder thread: fully decode each record, so the clustering side never touches the file
+	AlignmentRing *t_ring = ring.get();
+	decoder = std::thread([this, t_ring, contig_index] {
+		AlignmentRecord *slot;
+		while ((slot = t_ring -> fill_slot()) != nullptr) {
+			if (!this -> decode_core(*slot)) { break; }
+			this -> decode_nh(*slot);
+			this -> decode_cigar(*slot);
+			t_ring -> publish();
+			if (contig_index != -1 && slot -> ref_id != contig_index) { break; }
+		}
+		t_ring -> finish();
+	});
+}
+
+void AlignmentReader::stop_pipeline() {
+
+	if (ring == nullptr) { return; }
+
+	ring -> cancel();
+	if (decoder.joinable()) { decoder.join(); }
+
+	total_pops += ring -> pops;
+	total_fill += ring -> fill_sum;
+	total_empty_waits += ring -> empty_waits;
+	total_full_waits += ring -> full_waits;
+
+	ring.reset();
+	ring_record = nullptr;
+	ring_held = false;
+}
+
+// Average fill near 0 with many clustering waits: decoding is the bottleneck.
+//	Fill near capacity with many decoder waits: clustering is.
+void AlignmentReader::print_pipeline_stats(std::ostream &out) {
+	if (total_pops == 0) { return; }
+	const double fill = (double)total_fill / total_pops;
+	out << "//    Pipeline Ring......\n"
+	    << "//        records:            " << total_pops << "\n"
+	    << "//        average fill:       " << fill << " / " << ring_capacity << " (" << (100.0 * fill / ring_capacity) << "%)\n"
+	    << "//        clustering waited:  " << total_empty_waits << " times (decoder behind)\n"
+	    << "//        decoder waited:     " << total_full_waits << " times (clustering behind)\n";
+}
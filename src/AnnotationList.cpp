@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <stdexcept>
 
 #include "global_args.h"
@@ -68,11 +69,9 @@ void AnnotationList::add_line(const std::vector<std::string> &columns) {
 	// Get proper strand
 	GeneNode **head = &(AnnotationList::pos_head);
 	GeneNode **tail = &(AnnotationList::pos_tail);
-	std::unordered_map<std::string, GeneNode*> *chrom_map = &(AnnotationList::pos_chrom_map);
-	
+
 	if (columns[6] == "-") {
 		head = &(AnnotationList::neg_head); tail = &(AnnotationList::neg_tail);
-		chrom_map = &(AnnotationList::neg_chrom_map);
 	}
 
 	// If first gene on strand
@@ -86,11 +85,6 @@ void AnnotationList::add_line(const std::vector<std::string> &columns) {
 		
 		} else { AnnotationList::extend(columns); } // create new gene node
 	}
-
-	// If new chrom add to chrom map
-	if (chrom_map -> find(columns[0]) == chrom_map -> end()) {
-		(*chrom_map)[columns[0]] = *tail;
-	}
 }
 
 /////////////////////////////////////////////////////////////
@@ -134,6 +128,40 @@ void AnnotationList::create_gene_list() {
 	}
 }
 
+void AnnotationList::set_contig_ids(const std::unordered_map<int, std::string> &contig_map) {
+
+	std::unordered_map<std::string, int> contig_ids;
+	int contigs = 0;
+	for (const auto &pair : contig_map) {
+		contig_ids[pair.second] = pair.first;
+		contigs = std::max(contigs, pair.first + 1);
+	}
+
+	pos_contig_heads.assign(contigs, nullptr);
+	neg_contig_heads.assign(contigs, nullptr);
+
+	for (int t_strand = 0; t_strand < 2; t_strand++) {
+
+		std::vector<GeneNode*> &contig_heads = (t_strand == 0) ? pos_contig_heads : neg_contig_heads;
+
+		// Genes of a chromosome are contiguous from its first gene on (a later run of it is not reached)
+		std::unordered_set<std::string> seen;
+		int contig_id = -1;
+		for (GeneNode *gene = this -> get_head(t_strand); gene != nullptr; gene = gene -> get_next()) {
+			GeneNode *prev = gene -> get_prev();
+			if (prev == nullptr || prev -> get_chrom() != gene -> get_chrom()) {
+				contig_id = -1;
+				if (!seen.insert(gene -> get_chrom()).second) { continue; }
+				auto it = contig_ids.find(gene -> get_chrom());
+				if (it == contig_ids.end()) { continue; } // annotated, but no reads can land there
+				contig_id = it -> second;
+				contig_heads[contig_id] = gene;
+			}
+			if (contig_id != -1) { gene -> set_contig_id(contig_id); }
+		}
+	}
+}
+
 /////////////////////////////////////////////////////////////
 /* Output Functions */
 
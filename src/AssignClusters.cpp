@@ -19,7 +19,7 @@ GeneNode* get_closest_gene(const int &t, GeneNode *gene, const ClusterNode *clus
 	while (t > gene -> get_stop()) {
 		gene = gene -> get_next();
 		if (gene == nullptr)  { break; }
-		if (gene -> get_chrom() != clust -> get_contig_name()) {
+		if (gene -> get_contig_id() != clust -> get_contig_index()) {
 			gene = nullptr; break; // Not on same contig
 		}
 	}
@@ -29,18 +29,18 @@ GeneNode* get_closest_gene(const int &t, GeneNode *gene, const ClusterNode *clus
 /////////////////////////////////////////////////////////////
 /* Assignment Functions */
 
-// Resolve Read Assignment To Genes
-void resolve_read_assignment(GeneNode *gene, const int &max, std::vector<size_t> &read_assignments) {
+// Resolve Read Assignment To Genes (weight: identical reads folded into this one)
+void resolve_read_assignment(GeneNode *gene, const int &max, std::vector<size_t> &read_assignments, const size_t &weight) {
 
 	if (gene == nullptr && max != 0) {
-		read_assignments[2] += 1; // Add to ambiguous
+		read_assignments[2] += weight; // Add to ambiguous
 
 	} else if (max == 0) {
-		read_assignments[1] += 1; // Add to Unassigned
+		read_assignments[1] += weight; // Add to Unassigned
 
 	} else if (gene != nullptr) {
-		gene -> add_expression(1.0f); // add expression
-		read_assignments[0] += 1;
+		gene -> add_expression((long double)weight); // add expression
+		read_assignments[0] += weight;
 
  	} else {
  		throw std::runtime_error("ERROR: No best overlap found for read assignment.");
@@ -66,7 +66,7 @@ void resolve_transcript_assignment(ClusterList *list, ClusterNode *node, GeneNod
 
 	} else {
 		std::cerr << "ERROR: No best overlap found for read assignment.\n"
-				  << "Cluster: " << node -> get_contig_name() << ":" 
+				  << "Cluster: " << list -> get_contig_name() << ":" 
 				  << node -> get_start() << "-" << node -> get_stop() << "\n";
  		throw std::runtime_error("ERROR: No best overlap found for read assignment.");
  	}
@@ -104,7 +104,7 @@ int get_read_overlap(const int &a, const int &b, const GeneNode *gene) {
 }
 
 // Check the number of exons that overlap with transcript
-int get_transcript_overlap(const std::vector<int> &transcript, const GeneNode *gene) {
+int get_transcript_overlap(const ExonSpan &transcript, const GeneNode *gene) {
 
 	int matches = 0;
 	int i = 0, j = 0;
@@ -172,7 +172,6 @@ void assign_transcripts_to_genes(ClusterNode *node, GeneNode *prev_gene, Cluster
 	GeneNode *gene;
 	GeneNode *best_gene;
 	int t_stop, overlap, max_overlap;
-	std::vector<std::vector<int>> transcripts = *(node -> get_transcripts());
 
 	// Iterate through transcripts
 	for (int i = 0; i < t_num; i++) {
@@ -182,16 +181,17 @@ void assign_transcripts_to_genes(ClusterNode *node, GeneNode *prev_gene, Cluster
 		max_overlap = 0;
 		
 		// Get node stop (transcript end bounds the gene search)
-		t_stop = transcripts[i][transcripts[i].size() - 1];
+		const ExonSpan transcript = node -> get_transcript(i);
+		t_stop = transcript.back();
 
 		// Check all possible genes
 		while (t_stop >= gene -> get_start()) {
 			
-			overlap = get_transcript_overlap(transcripts[i], gene);
+			overlap = get_transcript_overlap(transcript, gene);
 			compare_and_update_overlap(gene, best_gene, overlap, max_overlap);
 
 			gene = gene -> get_next();
-			if (gene == nullptr || gene -> get_chrom() != node -> get_contig_name()) {
+			if (gene == nullptr || gene -> get_contig_id() != node -> get_contig_index()) {
 				break;
 			}
 		}
@@ -204,53 +204,43 @@ void assign_transcripts_to_genes(ClusterNode *node, GeneNode *prev_gene, Cluster
 void assign_reads_to_genes(const ClusterNode *node, GeneNode *prev_gene, ClusterList *list) {
 
 	GeneNode *gene;
-	GeneNode *best_gene = nullptr;   // init: the final resolve below would read these
-	int start, stop, overlap, max_overlap = 0, index;   // if vec_count were 0 (loop never runs)
+	GeneNode *best_gene;
+	int start, stop, overlap, max_overlap;
 
-	int prev_read = -1;
+	size_t weight;
 	std::vector<size_t> read_assignments = {0, 0, 0}; // {Assigned, Unassigned, Ambiguous}, could probably make an array
 
-	// Bind references once; these getters return the underlying vectors by const ref
-	const std::vector<int> &index_vec = node -> get_index_vec();
-	const std::vector<int> &five_vec = node -> get_five_vec();
-	const std::vector<int> &three_vec = node -> get_three_vec();
-
-	const int vec_count = node -> get_vec_count();
-	for (int i = 0; i < vec_count; i++) {
-
-		index = index_vec[i];
-		gene = prev_gene;
+	// Points are stored read by read, so each read's blocks are one contiguous run
+	const PointStore &points = node -> get_points();
 
-		// If onto new read, reset overlap stats
-		if (index != prev_read) {
+	const size_t reads = points.reads();
+	for (size_t r = 0; r < reads; r++) {
 
-			if (prev_read != -1) {
-				resolve_read_assignment(best_gene, max_overlap, read_assignments);
-			}
-
-			prev_read = index;
-			max_overlap = 0;
-			best_gene = nullptr;
-		}
+		weight = points.read_weight(r);
+		max_overlap = 0;
+		best_gene = nullptr;
 
+		const size_t last = points.read_end(r);
+		for (size_t i = points.read_begin(r); i < last; i++) {
 
-		start = five_vec[i];
-		stop = three_vec[i];
+			gene = prev_gene;
+			start = points.five(i);
+			stop = points.three(i);
 
-		// Check all possible genes
-		while (stop >= gene -> get_start()) {
-			overlap = get_read_overlap(start, stop, gene);
-			compare_and_update_overlap(gene, best_gene, overlap, max_overlap);
+			// Check all possible genes
+			while (stop >= gene -> get_start()) {
+				overlap = get_read_overlap(start, stop, gene);
+				compare_and_update_overlap(gene, best_gene, overlap, max_overlap);
 
-			gene = gene -> get_next();
-			if (gene == nullptr || gene -> get_chrom() != node -> get_contig_name()) {
-				break;
+				gene = gene -> get_next();
+				if (gene == nullptr || gene -> get_contig_id() != node -> get_contig_index()) {
+					break;
+				}
 			}
 		}
-	}
 
-	// Catch Last Read Assignment
-	resolve_read_assignment(best_gene, max_overlap, read_assignments);
+		resolve_read_assignment(best_gene, max_overlap, read_assignments, weight);
+	}
 
 	// Increment Counts (necessary to do at once because of precision loss)
 	for (int i = 0; i < 3; i++) {
@@ -267,16 +257,16 @@ void assign_reads_to_genes(const ClusterNode *node, GeneNode *prev_gene, Cluster
 /////////////////////////////////////////////////////////////
 /* Main Assignment Function */
 
-void assign_to_genes(AnnotationList &annotation, ClusterList *list, const std::string &chrom, const int &strand) {
+void assign_to_genes(AnnotationList &annotation, ClusterList *list, const int &strand) {
 	
 	int t_num, start;
 	ClusterNode *node = list -> get_head(strand);
 	GeneNode *prev_gene, *gene;
 
 	if (ImpaqtArguments::Args.stranded == "reverse") {
-		prev_gene = annotation.jump_to_chrom(chrom, !strand);
+		prev_gene = annotation.jump_to_contig(list -> get_contig_index(), !strand);
 	} else {
-		prev_gene = annotation.jump_to_chrom(chrom, strand);
+		prev_gene = annotation.jump_to_contig(list -> get_contig_index(), strand);
 	}
 
 	// If no genes
@@ -301,8 +291,8 @@ void assign_to_genes(AnnotationList &annotation, ClusterList *list, const std::s
 
 			} else {
 
-				node -> index_sort_vectors();
-				start = (node -> get_five_vec())[0];
+				node -> load_points();
+				start = node -> get_five(0);
 				gene = get_closest_gene(start, prev_gene, node);
 				if (gene != nullptr) {
 					assign_reads_to_genes(node, gene, list);				
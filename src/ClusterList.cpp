@@ -2,9 +2,8 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
-#include <api/BamAux.h>
-#include <api/BamReader.h>
 
+#include "AlignmentReader.h"
 #include "global_args.h"
 #include "utils.h"
 #include "ClusterList.h"
@@ -16,37 +15,37 @@
 /* Private Alignment Methods */
 
 // Process CIGAR Strings
-void ClusterList::calculate_splice(BamTools::BamAlignment &alignment, std::vector<int> &positions, std::vector<int> &junctions) {
+void ClusterList::calculate_splice(const AlignmentRecord &alignment, std::vector<int> &positions, std::vector<int> &junctions) {
 
 	int n_offset = 0;
-	int curr_pos = alignment.Position;
-	int n = alignment.CigarData.size();
+	int curr_pos = alignment.position;
+	int n = alignment.cigar.size();
 	positions.push_back(curr_pos);
 
 	for (int i = 0; i < n; i++) {
 
 		// If gapped alignment, get start and ends of neighboring aligned regions 
-		if (alignment.CigarData[i].Type == 'N') {
+		if (alignment.cigar[i].type == 'N') {
 			
 			junctions.push_back(curr_pos + 1);
-			n_offset = alignment.CigarData[i].Length;
+			n_offset = alignment.cigar[i].length;
 			curr_pos += n_offset;
 
-		} else if (alignment.CigarData[i].Type == 'M') {
-			curr_pos += alignment.CigarData[i].Length;
+		} else if (alignment.cigar[i].type == 'M') {
+			curr_pos += alignment.cigar[i].length;
 
 			// If gap detected and not last alignment
 			if (n_offset != 0 && i != n - 1) {
 
 				// If following D or I detected, skip, but only if no more gaps
-				if ((alignment.CigarData[i + 1].Type == 'I' ||
-					 alignment.CigarData[i + 1].Type == 'D') && 
+				if ((alignment.cigar[i + 1].type == 'I' ||
+					 alignment.cigar[i + 1].type == 'D') && 
 					 i + 2 == n - 1) {
 					continue;
 				}
 
 				positions.emplace_back(curr_pos - 1);
-				positions.emplace_back(curr_pos - alignment.CigarData[i].Length);
+				positions.emplace_back(curr_pos - alignment.cigar[i].length);
 				n_offset = 0;
 			}
 		}
@@ -54,28 +53,70 @@ void ClusterList::calculate_splice(BamTools::BamAlignment &alignment, std::vecto
 	}
 }
 
-// Check Read
-bool ClusterList::read_check(const BamTools::BamAlignment &alignment) {
+// Same walk as calculate_splice, but each block goes straight into the node (no intermediate vectors)
+void ClusterList::add_splice(ClusterNode *node, const AlignmentRecord &alignment) {
 
-	if (alignment.IsDuplicate()) { return false; }
-	if (!alignment.IsMapped()) { return false; }
+	int n_offset = 0;
+	int curr_pos = alignment.position;
+	int block_start = curr_pos;
+	const int n = alignment.cigar.size();
 
-	// Multimappers
-	uint16_t NH_tag;
-	alignment.GetTag("NH", NH_tag);
-	if (!ImpaqtArguments::Args.nonunique_alignments && NH_tag > 1) {
-		++ClusterList::multimapped_reads;
-		return false;
+	for (int i = 0; i < n; i++) {
+
+		const CigarEntry &op = alignment.cigar[i];
+		if (op.type == 'N') {
+
+			node -> add_junction(curr_pos + 1);
+			n_offset = op.length;
+			curr_pos += n_offset;
+
+		} else if (op.type == 'M') {
+			curr_pos += op.length;
+
+			// M after a gap ends a point pair and opens the next (same I/D exception as calculate_splice)
+			if (n_offset != 0 && i != n - 1) {
+
+				if ((alignment.cigar[i + 1].type == 'I' ||
+					 alignment.cigar[i + 1].type == 'D') && 
+					 i + 2 == n - 1) {
+					continue;
+				}
+
+				node -> add_block(block_start, curr_pos - 1);
+				block_start = curr_pos - op.length;
+				n_offset = 0;
+			}
+		}
+		if (i == n - 1) { node -> add_block(block_start, curr_pos - 1); }
 	}
+	node -> close_read();
+}
+
+// Check Read
+// Runs on the core record: flag tests first, NH only for reads that survive them, then MAPQ
+//	(NH stays ahead of MAPQ so multimapped and low quality reads are tallied as before)
+bool ClusterList::read_check(AlignmentReader &inFile, AlignmentRecord &alignment) {
+
+	if (alignment.is_duplicate()) { return false; }
+	if (!alignment.is_mapped()) { return false; }
 
 	// Exclude secondary alignment (do I need this?)
-	if (!alignment.IsPrimaryAlignment() && !ImpaqtArguments::Args.nonunique_alignments) {
+	if (!alignment.is_primary_alignment() && !ImpaqtArguments::Args.nonunique_alignments) {
 		++ClusterList::multimapped_reads;
 		return false;
 	}
 
+	// Multimappers
+	if (!ImpaqtArguments::Args.nonunique_alignments) {
+		inFile.load_nh(alignment);
+		if (alignment.nh > 1) {
+			++ClusterList::multimapped_reads;
+			return false;
+		}
+	}
+
 	// Enfore MAPQ filter
-	if (alignment.MapQuality < ImpaqtArguments::Args.mapq) {
+	if (alignment.mapq < ImpaqtArguments::Args.mapq) {
 		++ClusterList::low_quality_reads;
 		return false;
 	}
@@ -87,64 +128,33 @@ bool ClusterList::read_check(const BamTools::BamAlignment &alignment) {
 /////////////////////////////////////////////////////////////
 /* Private Node Methods */
 
-void ClusterList::initialize_list(const int t_strand, const int t_pos) {
-	ClusterNode *node = new ClusterNode(t_pos, t_strand,
-	                                    ClusterList::window_size, 
-	                                    ClusterList::contig_index, 
-	                                    ClusterList::contig_name);
-	set_head(node, t_strand); set_tail(node, t_strand);
+// Reads arrive in start order, so new nodes only ever go on the tail.
+//	Pointers into the arena are only good until the next extend_list.
+ClusterNode* ClusterList::extend_list(const int t_strand, const int t_pos) {
+	std::vector<ClusterNode> &nodes = get_arena(t_strand);
+	if (!nodes.empty()) { nodes.back().settle_points(); } // the old tail gets no more reads
+	nodes.emplace_back(t_pos, t_strand,
+	                   ClusterList::window_size, 
+	                   ClusterList::contig_index);
+	nodes.back().set_link(&nodes, nodes.size() - 1);
+	nodes.back().set_pool(&transcript_pool);
+	return &nodes.back();
 }
 
 
-ClusterNode* ClusterList::extend_list(ClusterNode *&curr, const int t_strand, const int t_pos) {
-	ClusterNode *node = new ClusterNode(t_pos, t_strand,
-	                                    ClusterList::window_size, 
-	                                    ClusterList::contig_index, 
-	                                    ClusterList::contig_name);
-	curr -> set_next(node);
-	node -> set_prev(curr);
-	return node;
+// Merge Neighboring Non-Zero Nodes (c_node swallows n_node in place, n_node's slot is left for compaction)
+void ClusterList::merge_nodes(ClusterNode *c_node, ClusterNode *n_node) {
+	c_node -> absorb(*n_node);
 }
 
 
-// Merge Neighboring Non-Zero Nodes
-void ClusterList::merge_nodes(ClusterNode *&c_node, ClusterNode *&t_head, ClusterNode *&t_tail) {
-
-	ClusterNode *n_node = c_node -> get_next();
-	n_node -> shrink_vectors();
-
-	ClusterNode *new_node = new ClusterNode(c_node, n_node);
-	new_node -> set_prev(c_node -> get_prev());
-
-	// If not first node
-	if (c_node -> get_prev() != nullptr) {
-		c_node -> get_prev() -> set_next(new_node);
-	
-	} else { t_head = new_node; }
-
-	// If not last node
-	if (n_node -> get_next() != nullptr) {
-		new_node -> set_next(n_node -> get_next());
-		new_node -> get_next() -> set_prev(new_node);
-	
-	} else { t_tail = new_node; }
-
-	delete n_node; delete c_node;
-	c_node = new_node;
-}
-
-
-// Delete every node in list
-void ClusterList::delete_list() {
-	ClusterNode *node = pos_head;
-	for (int i = 0; i < 2; i ++) {
-		if (i != 0) { node = neg_head; }
-		if (node == nullptr) { continue; } // empty strand (e.g. no reads) -> nothing to free
-		while (node -> get_next() != nullptr) {
-			node = node -> get_next();
-			delete node -> get_prev();
-		}
-		delete node;
+// Point every node at its slot again (after the arena moved or was compacted)
+void ClusterList::relink(const int t_strand) {
+	std::vector<ClusterNode> &nodes = get_arena(t_strand);
+	const int n = nodes.size();
+	for (int i = 0; i < n; i++) {
+		nodes[i].set_link(&nodes, i);
+		nodes[i].set_pool(&transcript_pool);
 	}
 }
 
@@ -152,113 +162,182 @@ void ClusterList::delete_list() {
 /* Cluster Functions */
 
 // Create read clusters
-bool ClusterList::create_clusters(BamTools::BamReader &inFile, BamTools::BamAlignment &alignment) {
+bool ClusterList::create_clusters(AlignmentReader &inFile, AlignmentRecord &alignment) {
 
-	int t_5end, t_3end;
+	int t_start;
 	int t_strand = 0; // Forward
 	bool found_reads = false;
-	std::vector<int> positions, junctions;
-	ClusterNode *pos_node = ClusterList::get_head(t_strand);
-	ClusterNode *neg_node = ClusterList::get_head(!t_strand);
+	ClusterNode *pos_node = ClusterList::get_tail(t_strand);
+	ClusterNode *neg_node = ClusterList::get_tail(!t_strand);
+
+	/*
+	  Tiles are cut where consecutive read starts (both strands, before filtering)
+	  are more than two windows apart: nodes are keyed on read starts, so no node
+	  on either side of such a gap can reach the other, even after collapsing.
+	  The cut is the first such gap after the nominal boundary, which this tile
+	  (closing) and the next tile (opening) find independently on the same reads.
+	*/
+	const int tile_gap = 2 * ClusterList::window_size;
+	bool seeking = (ClusterList::tile_start > 0);
+	int prev_open = -1;
+	int prev_close = -1;
+
+	/*
+	  Windowed lists stop at every such gap, holding the read after it: the
+	  nodes read so far are then closed and can be finished while the next
+	  batch is read into a fresh list.
+	*/
+	int prev_start = -1;
+	ClusterList::cut = -1;
 
 	while (true) {
 
-		if (!inFile.GetNextAlignment(alignment)) { break; }
-		if (alignment.RefID > ClusterList::contig_index) { break; }
+		if (!inFile.get_next_core(alignment)) { break; }
+		if (alignment.ref_id != ClusterList::contig_index) { inFile.hold(); break; } // left for the next contig when streaming
+
+		if (ClusterList::windowed) {
+			if (prev_start != -1 && alignment.position - prev_start > tile_gap) {
+				ClusterList::cut = alignment.position;
+				inFile.hold();
+				break;
+			}
+			prev_start = alignment.position;
+		}
+
+		// Stop where the next tile starts (checked first: if both cuts are the same gap, this tile is empty)
+		if (ClusterList::tile_stop != -1 && alignment.position >= ClusterList::tile_stop) {
+			if (prev_close != -1 && alignment.position - prev_close > tile_gap) { break; }
+			prev_close = alignment.position;
+		}
+
+		// Skip reads belonging to the previous tile
+		if (seeking) {
+			if (alignment.position < ClusterList::tile_start) { continue; }
+			if (prev_open == -1 || alignment.position - prev_open <= tile_gap) {
+				prev_open = alignment.position;
+				continue;
+			}
+			seeking = false;
+		}
 
 		total_reads += 1;
 
-		if (ClusterList::read_check(alignment) == false) { continue; }
+		if (ClusterList::read_check(inFile, alignment) == false) { continue; }
+		inFile.load_cigar(alignment);
 
 		found_reads = true;
-		positions.clear();
-		junctions.clear();
-		ClusterList::calculate_splice(alignment, positions, junctions); // Get Gapped Alignments
+		t_start = alignment.position; // left most: 5' end forward, 3' end reverse
 
 		// Process in Strand Specific way
-		if (alignment.IsReverseStrand()) {
+		if (alignment.is_reverse_strand()) {
 
-			t_5end = positions.back();
-			t_3end = positions[0];
 			passing_neg_reads += 1;
 
-			if (ClusterList::neg_head == nullptr) {
-				ClusterList::initialize_list(!t_strand, t_3end);
-				neg_node = ClusterList::get_head(!t_strand);
+			if (neg_node == nullptr) {
+				neg_node = ClusterList::extend_list(!t_strand, t_start);
 
 			} else {
 
 				// Advance based on 3' position (left most)
-				ClusterList::jump_to_cluster(neg_node, t_3end);
+				ClusterList::jump_to_cluster(neg_node, t_start);
 			}
 
-			if (t_3end > neg_node -> get_stop()) {
-				neg_node = ClusterList::extend_list(neg_node, !t_strand, t_3end);
+			if (t_start > neg_node -> get_stop()) {
+				neg_node = ClusterList::extend_list(!t_strand, t_start);
 			}
 
-			neg_node -> add_alignment(positions, junctions);
+			ClusterList::add_splice(neg_node, alignment);
 
 		} else {
 
-			t_5end = positions[0];
-			t_3end = positions.back();
 			passing_pos_reads += 1;
 
-			if (ClusterList::pos_head == nullptr) {
-				ClusterList::initialize_list(t_strand, t_5end);
-				pos_node = ClusterList::get_head(t_strand);
+			if (pos_node == nullptr) {
+				pos_node = ClusterList::extend_list(t_strand, t_start);
 
 			} else {
 
 				// Advance based on 5' position (left most)
-				ClusterList::jump_to_cluster(pos_node, t_5end);
+				ClusterList::jump_to_cluster(pos_node, t_start);
 			}
 
-			if (t_5end > pos_node -> get_stop()) {
-				pos_node = ClusterList::extend_list(pos_node, t_strand, t_5end);
+			if (t_start > pos_node -> get_stop()) {
+				pos_node = ClusterList::extend_list(t_strand, t_start);
 			}
 
-			pos_node -> add_alignment(positions, junctions);
+			ClusterList::add_splice(pos_node, alignment);
 		}
 	}
 	return found_reads;
 }
 
-// Combine clusters with nonzero neighbors
+// Combine clusters with nonzero neighbors (compacting the arena as nodes are swallowed)
 void ClusterList::collapse_clusters(int t_strand) {
 
 	int dist;
-	ClusterNode *t_head = ClusterList::get_head(t_strand);
-	ClusterNode *t_tail = ClusterList::get_tail(t_strand);
-	ClusterNode *node = t_head;
+	std::vector<ClusterNode> &nodes = ClusterList::get_arena(t_strand);
+	const size_t n = nodes.size();
 
 	// If not Init
-	if (node == nullptr) { return; }
+	if (n == 0) { return; }
 
-	while (node != nullptr) {
+	size_t kept = 0;
+	size_t next = 0;
+	while (next < n) {
 
-		node -> shrink_vectors();
+		if (kept != next) { nodes[kept] = std::move(nodes[next]); }
+		ClusterNode *node = &nodes[kept];
+		next += 1;
 
-		while (node -> get_next() != nullptr) {
+		while (next < n) {
 
-			dist = (node -> get_next() -> get_start()) - (node -> get_stop());
+			dist = (nodes[next].get_start()) - (node -> get_stop());
 			if (dist > ClusterList::window_size) { break; }
 
 			// If next cluster is within merge range
-			ClusterList::merge_nodes(node, t_head, t_tail);
+			ClusterList::merge_nodes(node, &nodes[next]);
+			next += 1;
 		}
 
-		node = node -> get_next();
+		node -> shrink_vectors(); // once, after the last swallow
+		node -> settle_points();
+		kept += 1;
 	}
 
-	// Adjust head and tail nodes by strand
-	if (t_strand == 0) {
-		ClusterList::pos_head = t_head; 
-		ClusterList::pos_tail = t_tail;
-	} else {
-		ClusterList::neg_head = t_head; 
-		ClusterList::neg_tail = t_tail;
+	nodes.erase(nodes.begin() + kept, nodes.end());
+	ClusterList::relink(t_strand);
+}
+
+
+// Move the nodes, transcripts and read counts of the following tile onto the end of this list
+void ClusterList::append_list(ClusterList *tile) {
+
+	const uint32_t shift = transcript_pool.append(tile -> transcript_pool);
+
+	for (int t_strand = 0; t_strand < 2; t_strand++) {
+
+		std::vector<ClusterNode> &t_nodes = tile -> get_arena(t_strand);
+		if (t_nodes.empty()) { continue; }
+
+		std::vector<ClusterNode> &nodes = ClusterList::get_arena(t_strand);
+		const size_t first = nodes.size();
+		if (nodes.empty()) {
+			nodes.swap(t_nodes);
+		} else {
+			nodes.insert(nodes.end(), std::make_move_iterator(t_nodes.begin()), std::make_move_iterator(t_nodes.end()));
+		}
+		for (size_t i = first; i < nodes.size(); i++) { nodes[i].rebase_transcripts(shift); }
+		ClusterList::relink(t_strand);
+
+		// Tile no longer owns these nodes
+		t_nodes.clear();
 	}
+
+	multimapped_reads += tile -> multimapped_reads;
+	low_quality_reads += tile -> low_quality_reads;
+	total_reads += tile -> total_reads;
+	passing_pos_reads += tile -> passing_pos_reads;
+	passing_neg_reads += tile -> passing_neg_reads;
 }
 
 
@@ -266,14 +345,14 @@ void ClusterList::collapse_clusters(int t_strand) {
 /* Output Functions */
 
 // Write Clusters to GTF File
-void ClusterList::write_clusters_as_GTF(std::ofstream &gtfFile) {
+void ClusterList::write_clusters_as_GTF(std::ostream &gtfFile) {
 
 	// Cancel if empty chromosome
-	if (ClusterList::pos_head == nullptr && ClusterList::neg_head == nullptr) { return; }
+	if (ClusterList::pos_nodes.empty() && ClusterList::neg_nodes.empty()) { return; }
 
 	bool strand;
-	ClusterNode *prev_pos = ClusterList::pos_head;
-	ClusterNode *prev_neg = ClusterList::neg_head;
+	ClusterNode *prev_pos = ClusterList::get_head(0);
+	ClusterNode *prev_neg = ClusterList::get_head(1);
 	ClusterNode *node = ClusterList::get_first_cluster(strand);
 
 	// Iterate Through Clusters
@@ -282,7 +361,7 @@ void ClusterList::write_clusters_as_GTF(std::ofstream &gtfFile) {
 		// If no more clusters
 		if (prev_pos == nullptr && prev_neg == nullptr) { break; }
 
-		node -> ClusterNode::write_transcripts(gtfFile);
+		node -> ClusterNode::write_transcripts(gtfFile, ClusterList::contig_name);
 
 		// Get Next Cluster by position
 		if (strand == 0) {
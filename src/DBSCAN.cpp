@@ -1,9 +1,11 @@
 #include <iostream>
 #include <iomanip>
+#include <numeric>
 
 #include "ClusterList.h"
 #include "DBSCAN.h"
 #include "ContainmentList.h"
+#include "NodePool.h"
 #include "utils.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -182,15 +184,19 @@ void get_coordinates(const std::map<Path, int> &paths,
 
 // Find all linked DBSCAN clusters
 void get_linked_clusters(ClusterNode *node, std::map<Path, int> &path_map,
-                         const std::vector<int> &assign_5, const std::vector<int> &assign_3) {
+                         const std::vector<int> &assign_5, const std::vector<int> &assign_3,
+                         const std::vector<int> *t_weights) {
 
 	const int n = node -> get_vec_count();
+	std::vector<int> node_weights;
+	if (t_weights == nullptr) { node_weights = node -> get_point_weights(); }
+	const std::vector<int> &weights = t_weights ? *t_weights : node_weights;
 	for (int i = 0; i < n; i++) {
 
 		// Skip points unassigned in both the 5' and 3' DBSCAN
 		if (assign_5.at(i) == -1 && assign_3.at(i) == -1) { continue; }
 
-		path_map[Path{assign_5.at(i), assign_3.at(i)}] += 1;
+		path_map[Path{assign_5.at(i), assign_3.at(i)}] += weights.empty() ? 1 : weights[i];
 	}
 
 	// Absorb orphan paths: a path with only one prime assigned is dropped if
@@ -218,82 +224,138 @@ void get_linked_clusters(ClusterNode *node, std::map<Path, int> &path_map,
 
 
 // Get Nearest Neighbors 
-std::vector<int> get_nearest_neighbors(const int &i, const int &points, std::vector<bool> &queued,
-                           			   const std::vector<int> &indices, const std::vector<int> *adj_vec) {
+//	weight: reads behind the neighbors plus the other reads folded into point i
+template <typename T>
+void get_nearest_neighbors(const int &i, const int &points, EpochMarks *queued,
+                           const std::vector<T> &sorted, const std::vector<int> &sorted_weights,
+                           std::vector<int> &neighbors, int &weight) {
 
 	int bound;
-	int p = indices[i];
-	std::vector<int> neighbors;
+	neighbors.clear();
+	weight = sorted_weights[i] - 1;
 
 	// Forward Search
-	bound = (adj_vec -> at(p)) + ImpaqtArguments::Args.epsilon;
+	bound = (int)sorted[i] + ImpaqtArguments::Args.epsilon;
 	for (int j = i + 1; j < points; j++) {
-		if (adj_vec -> at(indices[j]) > bound) { break; }
-		if (!queued.empty()) { queued[j] = true; }
+		if ((int)sorted[j] > bound) { break; }
+		if (queued != nullptr) { queued -> set(j); }
 		neighbors.push_back(j);
+		weight += sorted_weights[j];
 	}
 
 	// Backward Search
-	bound = (adj_vec -> at(p)) - ImpaqtArguments::Args.epsilon;
+	bound = (int)sorted[i] - ImpaqtArguments::Args.epsilon;
 	for (int j = i - 1; j >= 0; j--) {
-		if (adj_vec -> at(indices[j]) < bound) { break; }
-		if (!queued.empty()) { queued[j] = true; }
+		if ((int)sorted[j] < bound) { break; }
+		if (queued != nullptr) { queued -> set(j); }
 		neighbors.push_back(j);
+		weight += sorted_weights[j];
 	}
-
-	return neighbors;
 } 
 
+template void get_nearest_neighbors<uint16_t>(const int &, const int &, EpochMarks *,
+                                              const std::vector<uint16_t> &, const std::vector<int> &, std::vector<int> &, int &);
+template void get_nearest_neighbors<uint32_t>(const int &, const int &, EpochMarks *,
+                                              const std::vector<uint32_t> &, const std::vector<int> &, std::vector<int> &, int &);
+
+
+// Core points chained within epsilon of each other: the first and last core, and the
+//	sorted points their windows cover
+struct CoreRun {
+	int first, last;
+	int left, right;
+};
+
+// Buffers one thread reuses across DBSCAN calls. They keep the size
+//	of the largest node seen, so a contig's many small nodes allocate nothing.
+template <typename T>
+struct DBSCANScratch {
+	std::vector<uint64_t> pairs, pairs_tmp;    // offset << 32 | index, see sort_offsets
+	std::vector<int> indices;
+	std::vector<T> sorted;
+	std::vector<int> sorted_weights;
+	std::vector<int> neighbors, sub_neighbors;
+	std::vector<int> cluster_points;
+	EpochMarks visited;                        // new epoch per call
+	EpochMarks queued;                         // new epoch per seed point
+	std::vector<std::vector<CoreRun>> chunk_runs;
+	std::vector<CoreRun> clusters;
+};
+
+template <typename T>
+static DBSCANScratch<T> &dbscan_scratch() {
+	static thread_local DBSCANScratch<T> scratch;
+	return scratch;
+}
+
 
-// DBSCAN Clustering Function, inspired by https://github.com/Eleobert/dbscan/blob/master/dbscan.cpp
-std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_counts,
-                        std::map<int, std::vector<int>> &regions, const bool &five) {
+// Sorted permutation of one prime's offsets (adj[2i], see PointStore), with offsets
+//	and weights gathered alongside so both kernels scan contiguous memory. Offsets
+//	are radix sorted packed with their point index, so the sort moves one array and
+//	equal offsets stay in point order.
+template <typename T>
+static void sort_offsets(const T *adj, const std::vector<int> &weights, const int &points, DBSCANScratch<T> &scratch) {
+	std::vector<uint64_t> &pairs = scratch.pairs;
+	pairs.resize(points);
+	for (int i = 0; i < points; i++) { pairs[i] = ((uint64_t)adj[2 * i] << 32) | (uint32_t)i; }
+	radix_sort_pairs(pairs, scratch.pairs_tmp);
+
+	std::vector<int> &indices = scratch.indices;
+	indices.resize(points);
+	scratch.sorted.resize(points);
+	scratch.sorted_weights.resize(points);
+	for (int i = 0; i < points; i++) {
+		indices[i] = (int)(uint32_t)pairs[i];
+		scratch.sorted[i] = (T)(pairs[i] >> 32);
+		scratch.sorted_weights[i] = weights.empty() ? 1 : weights[indices[i]];
+	}
+}
+
+
+// DBSCAN over one prime's offsets, in the node's point order: per-point neighbor scans
+//	from each seed (the "scan" kernel, kept to validate dbscan_linear against).
+template <typename T>
+static std::vector<int> dbscan_offsets(const T *adj, const std::vector<int> &weights, const int &base,
+                                       const int &points, const int &min_counts, std::map<int, std::vector<int>> &regions) {
 
+	DBSCANScratch<T> &scratch = dbscan_scratch<T>();
 
 	// DBSCAN Variables
  	bool skip;
 	int clust_num = 0;
 	int p1, p2, index;
+	int weight, sub_weight;
 	int min_point, max_point;
-	std::vector<int> *adj_vec;
-	std::vector<bool> empty_vec;
-	std::vector<int> neighbors, sub_neighbors;
+	std::vector<int> &neighbors = scratch.neighbors;
+	std::vector<int> &sub_neighbors = scratch.sub_neighbors;
+	std::vector<int> &cluster_points = scratch.cluster_points;
+	EpochMarks &visited = scratch.visited;
+	EpochMarks &queued = scratch.queued;
 
 	// Indexing Variables
-	std::vector<int> indices(points);
+	const std::vector<int> &indices = scratch.indices;
+	const std::vector<T> &sorted = scratch.sorted;
+	const std::vector<int> &sorted_weights = scratch.sorted_weights;
 	std::vector<int> assign_vec(points, -1);
-	std::vector<bool> visted(points, false);
-
-
-	adj_vec = node -> get_five_ref();
-	std::iota(indices.begin(), indices.end(), 0);
-
-	// If dealing with the unsorted vector, get sorted indices
-	if (!five) {
-		adj_vec = node -> get_three_ref();
-		std::sort(indices.begin(), indices.end(),
-			       [&](int i, int j) -> bool {
-			            return (*adj_vec)[i] < (*adj_vec)[j];
-			        }
-		         );
-	}
+	visited.reset(points);
+	sort_offsets(adj, weights, points, scratch);
 
 
 	for (int i = 0; i < points; i++) {
 
-		if (visted[i] == true) { continue; }
+		if (visited.test(i)) { continue; }
 
 		p1 = indices[i];
-		std::vector<bool> queued(points, false);
+		queued.reset(points);
 		
-		neighbors = get_nearest_neighbors(i, points, queued, indices, adj_vec);
+		get_nearest_neighbors(i, points, &queued, sorted, sorted_weights, neighbors, weight);
 
-		// If core point
-		if ((int)neighbors.size() >= min_counts) {
+		// If core point (counting every read, not every stored point)
+		if (weight >= min_counts) {
 
-			visted[i] = true;
+			visited.set(i);
 			assign_vec.at(p1) = clust_num;
-			std::vector<int> cluster_points = {adj_vec -> at(p1)};
+			cluster_points.assign(1, (int)sorted[i]);
 
 			int x = 0;
 			while (x < (int)neighbors.size()) {
@@ -301,14 +363,14 @@ std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_cou
 				index = neighbors[x];
 				p2 = indices[index];
 
-				if (visted[index] == false) {
+				if (!visited.test(index)) {
 
 					// Skip Duplicate Points
 					skip = false;
 					for (const auto &t_point : cluster_points) {
-						if (adj_vec -> at(p2) == t_point) {
+						if ((int)sorted[index] == t_point) {
 							assign_vec.at(p2) = clust_num;
-							visted[index] = true;
+							visited.set(index);
 							skip = true; 
 							break;
 						}
@@ -316,20 +378,20 @@ std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_cou
 
 					if (!skip) {
 
-						visted[index] = true;
+						visited.set(index);
 						assign_vec.at(p2) = clust_num;
 
-						sub_neighbors = get_nearest_neighbors(index, points, empty_vec, indices, adj_vec);
+						get_nearest_neighbors(index, points, (EpochMarks*)nullptr, sorted, sorted_weights, sub_neighbors, sub_weight);
 
 						// If also a core point, copy subneighbors into neighbors to also be checked
-						if ((int)sub_neighbors.size() >= min_counts) {
+						if (sub_weight >= min_counts) {
 							for (const auto &n : sub_neighbors) {
-								if (!queued[n]) {
+								if (!queued.test(n)) {
 									neighbors.push_back(n);
-									queued[n] = true;
+									queued.set(n);
 								}
 							}
-							cluster_points.push_back(adj_vec -> at(p2));
+							cluster_points.push_back((int)sorted[index]);
 						}
 					}					
 				}
@@ -338,7 +400,7 @@ std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_cou
 
 			min_point = *std::min_element(cluster_points.begin(), cluster_points.end());
 			max_point = *std::max_element(cluster_points.begin(), cluster_points.end());
-			regions[clust_num] = std::vector<int>{min_point, max_point};
+			regions[clust_num] = std::vector<int>{base + min_point, base + max_point};
 			clust_num += 1;
 			i = x - 1; // Skip to next unvisited point
 		}
@@ -347,110 +409,276 @@ std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_cou
 	return assign_vec;
 }
 
-// Initiate Transcript Identifying Procedure
-void identify_transcripts_dbscan(ClusterList *cluster,  const int &strand) {
 
-	float density;
-	bool prime_5 = true;
-	int expr, points, min_counts;
-	int count_threshold = std::max(ImpaqtArguments::Args.min_count, 10);
+// Nodes with at least this many points per thread run the linear kernel in chunks (see dbscan_linear)
+static int parallel_points = 1 << 17;
 
-	std::map<Path, int> paths;
-	std::vector<int> counts;
-	std::vector<std::vector<int>> transcripts;
-	std::vector<int> assign_vec_5, assign_vec_3;
-	std::map<int, std::vector<int>> regions_5, regions_3;
+void set_dbscan_parallel_points(const int &points) { parallel_points = points; }
 
-	ClusterNode *node = cluster -> get_head(strand);
 
-	while (node != nullptr) {
+// Run fn(0..chunks-1): chunk 0 on this thread, the rest as NodePool tasks that idle workers
+//	take (or this thread runs itself once chunk 0 is done, when every worker is busy)
+template <typename F>
+static void run_chunks(const int &chunks, F fn) {
+	NodePool::Group group;
+	for (int c = 1; c < chunks; c++) { NodePool::submit(group, [&fn, c] { fn(c); }); }
+	fn(0);
+	NodePool::join(group); // not wait: this thread's DBSCAN scratch is still in use
+}
+
 
-		expr = node -> get_read_count();
-		points = node -> get_vec_count();
+// Core runs of sorted points [a, b): each point's window by two pointers (equal offsets keep the
+//	previous one), starting from a binary-searched window at a
+template <typename T>
+static void find_core_runs(const std::vector<T> &sorted, const std::vector<int> &sorted_weights, const int &points,
+                           const int &a, const int &b, const int &min_counts, std::vector<CoreRun> &runs) {
 
-		// If threshold for transcript detection is reached
-		if (expr >= count_threshold) {
+	const int epsilon = ImpaqtArguments::Args.epsilon;
+	runs.clear();
+	if (a >= b) { return; }
 
-			// Reset Data
-			paths.clear();
-			regions_5.clear();
-			regions_3.clear();
-			transcripts.clear();
-			counts.clear();
+	const int start = (int)sorted[a];
+	int lo = std::lower_bound(sorted.begin(), sorted.end(), start - epsilon,
+	                          [](const T &v, const int &x) { return (int)v < x; }) - sorted.begin();
+	int hi = std::upper_bound(sorted.begin(), sorted.end(), start + epsilon,
+	                          [](const int &x, const T &v) { return x < (int)v; }) - sorted.begin() - 1;
+	int weight = 0;
+	for (int j = lo; j <= hi; j++) { weight += sorted_weights[j]; }
 
-			// Sort vectors
-			node -> point_sort_vectors();
+	for (int i = a; i < b; i++) {
 
-			// BNJ - 6/16/2025: Pleaseeeeee fix this casting
-			density = (float)expr / (float)(node -> get_stop() - node -> get_start());
-			min_counts = std::max((int)((float)expr * (((float)ImpaqtArguments::Args.count_percentage / 100.0))), 10);
+		// Slide the window
+		if (i != a && sorted[i] != sorted[i - 1]) {
+			while (hi + 1 < points && (int)sorted[hi + 1] <= (int)sorted[i] + epsilon) { weight += sorted_weights[++hi]; }
+			while ((int)sorted[lo] < (int)sorted[i] - epsilon) { weight -= sorted_weights[lo++]; }
+		}
+
+		// Core point (counting every read but itself)
+		if (weight - 1 < min_counts) { continue; }
+
+		if (!runs.empty() && (int)sorted[i] - (int)sorted[runs.back().last] <= epsilon) {
+			runs.back().last = i;
+			runs.back().right = hi;
+		} else {
+			runs.push_back(CoreRun{i, i, lo, hi});
+		}
+	}
+}
 
-			// If not in quantification mode
-			if (ImpaqtArguments::Args.density_threshold == 0 || density < ImpaqtArguments::Args.density_threshold) {
-				assign_vec_5 = dbscan(node, points, min_counts, regions_5, prime_5);
-				assign_vec_3 = dbscan(node, points, min_counts, regions_3, !prime_5);
 
+// DBSCAN over one prime's offsets with one sliding window over the sorted points: same assign_vec and regions as dbscan_offsets.
+//	A point's neighborhood is the window of sorted points within epsilon, so two pointers
+//	give every point's window and weight. Core points chain into one cluster while
+//	consecutive cores are within epsilon; the cluster takes every point in the windows of
+//	its first to last core, except points the previous cluster already took, and its
+//	region runs from its first to its last core offset.
+//	Deep nodes (parallel_points per chunk, at most --threads chunks) are split into chunks
+//	found as NodePool tasks; a chunk's first run joins the previous chunk's last when their
+//	cores are within epsilon, and points are then assigned by range the same way.
+template <typename T>
+static std::vector<int> dbscan_linear(const T *adj, const std::vector<int> &weights, const int &base,
+                                      const int &points, const int &min_counts, std::map<int, std::vector<int>> &regions) {
+
+	DBSCANScratch<T> &scratch = dbscan_scratch<T>();
+	const std::vector<T> &sorted = scratch.sorted;
+	const std::vector<int> &sorted_weights = scratch.sorted_weights;
+	const std::vector<int> &indices = scratch.indices;
+	const int epsilon = ImpaqtArguments::Args.epsilon;
+	std::vector<int> assign_vec(points, -1);
+	sort_offsets(adj, weights, points, scratch);
+
+	// Chunks (one unless the node is deep)
+	const int chunks = (points >= 2 * parallel_points) ? std::min(points / parallel_points, std::max(ImpaqtArguments::Args.threads, 1)) : 1;
+	std::vector<std::vector<CoreRun>> &chunk_runs = scratch.chunk_runs;
+	if ((int)chunk_runs.size() < chunks) { chunk_runs.resize(chunks); }
+	auto chunk_start = [&](const int &c) { return (int)((long long)points * c / chunks); };
+
+	run_chunks(chunks, [&](const int c) {
+		find_core_runs(sorted, sorted_weights, points, chunk_start(c), chunk_start(c + 1), min_counts, chunk_runs[c]);
+	});
+
+	// Merge runs across chunk boundaries; clip each cluster to the points the previous one left
+	std::vector<CoreRun> &clusters = scratch.clusters;
+	clusters.clear();
+	for (int c = 0; c < chunks; c++) {
+		for (const CoreRun &run : chunk_runs[c]) {
+			if (!clusters.empty() && (int)sorted[run.first] - (int)sorted[clusters.back().last] <= epsilon) {
+				clusters.back().last = run.last;
+				clusters.back().right = run.right;
 			} else {
-				// If read mitochrondrial genome detected, don't bother loll
-				std::cerr << "//    NOTICE: Density threshold met (" 
-						  << std::fixed << std::setprecision(2) << density << "). Skipping "
-						  << node -> get_contig_name() << ":" 
-						  << node -> get_start() << "-" 
-						  << node -> get_stop() << ".\n";
-				node = node -> get_next();
-				continue;	
+				clusters.push_back(run);
 			}
-			
-			// If clusters were not found
-			if (regions_5.empty() && regions_3.empty()) {
-				;
-			
-			} else {
+		}
+	}
+	const int n_clusters = clusters.size();
+	for (int k = 0; k < n_clusters; k++) {
+		if (k > 0) { clusters[k].left = std::max(clusters[k].left, clusters[k - 1].right + 1); }
+		regions[k] = std::vector<int>{base + (int)sorted[clusters[k].first], base + (int)sorted[clusters[k].last]};
+	}
 
-				// If clusters were  found
-				get_linked_clusters(node, paths, assign_vec_5, assign_vec_3);
+	// Assign by point range (clusters are disjoint and in order after clipping)
+	run_chunks(chunks, [&](const int c) {
+		const int a = chunk_start(c);
+		const int b = chunk_start(c + 1);
+		int k = std::lower_bound(clusters.begin(), clusters.end(), a,
+		                         [](const CoreRun &run, const int &x) { return run.right < x; }) - clusters.begin();
+		for (; k < n_clusters && clusters[k].left < b; k++) {
+			const int stop = std::min(clusters[k].right, b - 1);
+			for (int p = std::max(clusters[k].left, a); p <= stop; p++) { assign_vec[indices[p]] = k; }
+		}
+	});
 
-				get_coordinates(paths,
-				                regions_5, regions_3,
-				                &transcripts, &counts);
+	return assign_vec;
+}
 
-				// If no transcripts have at least 10 supporting reads. (maybe don't hardcode this?)
-				if (!transcripts.empty()) {
 
-					overlap_clusters(node, transcripts, counts);
+// DBSCAN Clustering Function, inspired by https://github.com/Eleobert/dbscan/blob/master/dbscan.cpp
+//	One-dimensional, so the linear kernel is the default; --dbscan-kernel scan runs the neighbor scans.
+std::vector<int> dbscan(ClusterNode *node, const int &points, const int &min_counts,
+                        std::map<int, std::vector<int>> &regions, const bool &five,
+                        const std::vector<int> *t_weights) {
+	std::vector<int> node_weights;
+	if (t_weights == nullptr) { node_weights = node -> get_point_weights(); }
+	const std::vector<int> &weights = t_weights ? *t_weights : node_weights;
+	const bool scan = (ImpaqtArguments::Args.dbscan_kernel == "scan");
+	return node -> visit_points([&](const auto *pairs) {
+		const auto *adj = five ? pairs : pairs + 1;
+		if (scan) { return dbscan_offsets(adj, weights, node -> get_point_base(), points, min_counts, regions); }
+		return dbscan_linear(adj, weights, node -> get_point_base(), points, min_counts, regions);
+	});
+}
 
-					// Clean up (close gaps of single clusters not representing splice junctions)
-					const int n_trans = transcripts.size();
-					for (int i = 0; i < n_trans; i ++) {
-						if (transcripts[i].size() != 4) { continue; }
-						if (!(node -> contains_junction(transcripts[i][1], transcripts[i][2]))) {
-							transcripts[i] = {transcripts[i][0], transcripts[i][3]};
-						}
-					}
+// One node's DBSCAN results, reported once every node of the strand is done
+struct NodeTranscripts {
+	ClusterNode *node = nullptr;
+	bool dense = false;                        // density threshold met, not clustered
+	float density = 0;
+	std::vector<std::vector<int>> transcripts;
+	std::vector<int> counts;
+};
 
-					report_transcripts(node, transcripts, counts);
-					node -> empty_vectors();
-				}
 
+// DBSCAN, link and overlap one node's points into result (everything but reporting, which
+//	appends to the contig's transcript pool)
+static void find_node_transcripts(NodeTranscripts &result) {
+
+	ClusterNode *node = result.node;
+	std::map<Path, int> paths;
+	std::vector<int> assign_vec_5, assign_vec_3;
+	std::map<int, std::vector<int>> regions_5, regions_3;
+	std::vector<std::vector<int>> &transcripts = result.transcripts;
+	std::vector<int> &counts = result.counts;
+
+	const bool prime_5 = true;
+	const int expr = node -> get_read_count();
+	const int points = node -> get_vec_count();
+
+	node -> load_points();
+
+	// BNJ - 6/16/2025: Pleaseeeeee fix this casting
+	const float density = (float)expr / (float)(node -> get_stop() - node -> get_start());
+	const int min_counts = std::max((int)((float)expr * (((float)ImpaqtArguments::Args.count_percentage / 100.0))), 10);
+
+	// If read mitochrondrial genome detected, don't bother loll
+	if (ImpaqtArguments::Args.density_threshold != 0 && !(density < ImpaqtArguments::Args.density_threshold)) {
+		result.dense = true;
+		result.density = density;
+		node -> settle_points();
+		return;
+	}
+
+	// Weights of every point, built once for both DBSCANs and the linking
+	const std::vector<int> weights = node -> get_point_weights();
+	assign_vec_5 = dbscan(node, points, min_counts, regions_5, prime_5, &weights);
+	assign_vec_3 = dbscan(node, points, min_counts, regions_3, !prime_5, &weights);
+
+	// If clusters were found
+	if (!regions_5.empty() || !regions_3.empty()) {
+
+		get_linked_clusters(node, paths, assign_vec_5, assign_vec_3, &weights);
+
+		get_coordinates(paths,
+		                regions_5, regions_3,
+		                &transcripts, &counts);
+
+		// If no transcripts have at least 10 supporting reads. (maybe don't hardcode this?)
+		if (!transcripts.empty()) {
+
+			overlap_clusters(node, transcripts, counts);
+
+			// Clean up (close gaps of single clusters not representing splice junctions)
+			const int n_trans = transcripts.size();
+			for (int i = 0; i < n_trans; i ++) {
+				if (transcripts[i].size() != 4) { continue; }
+				if (!(node -> contains_junction(transcripts[i][1], transcripts[i][2]))) {
+					transcripts[i] = {transcripts[i][0], transcripts[i][3]};
+				}
 			}
+
+			node -> empty_vectors();
+		}
+	}
+
+	// Points kept for read assignment
+	node -> settle_points();
+}
+
+
+// Initiate Transcript Identifying Procedure
+//	Each node over the count threshold is a NodePool task; the strand joins on them, then
+//	reports their transcripts (and density notices) in node order, as one thread would have.
+void identify_transcripts_dbscan(ClusterList *cluster,  const int &strand) {
+
+	const int count_threshold = std::max(ImpaqtArguments::Args.min_count, 10);
+
+	std::vector<NodeTranscripts> results;
+	ClusterNode *node = cluster -> get_head(strand);
+	while (node != nullptr) {
+		if ((int)node -> get_read_count() >= count_threshold) {
+			results.emplace_back();
+			results.back().node = node;
 		}
 		node = node -> get_next();
 	}
+
+	// results is not resized past here, so tasks can hold on to their entry
+	NodePool::Group group;
+	for (auto &result : results) {
+		NodePool::submit(group, [&result] { find_node_transcripts(result); });
+	}
+	NodePool::wait(group);
+
+	for (auto &result : results) {
+		if (result.dense) {
+			std::cerr << "//    NOTICE: Density threshold met (" 
+			          << std::fixed << std::setprecision(2) << result.density << "). Skipping "
+			          << cluster -> get_contig_name() << ":" 
+			          << result.node -> get_start() << "-" 
+			          << result.node -> get_stop() << ".\n";
+			continue;
+		}
+		if (!result.transcripts.empty()) { report_transcripts(result.node, result.transcripts, result.counts); }
+	}
 }
 
 
 void merge_transcripts(ClusterNode *c_node, ClusterNode *n_node) {
 
-	std::vector<std::vector<int>> transcripts = *(c_node -> get_transcripts());
-	std::vector<int> counts(c_node -> get_transcript_num(), 0);
+	std::vector<std::vector<int>> transcripts;
+	std::vector<int> counts;
 
-	// Populate New Transcript and Count Vecs
+	// Populate New Transcript and Count Vecs (copied out: re-reporting grows the pool under the spans)
 	const int cn = c_node -> get_transcript_num();
 	const int nn = n_node -> get_transcript_num();
-	for (int i = 0; i < cn; i++) { counts[i] = (int)(c_node -> get_transcript_expr(i)); }
-	for (int i = 0; i < nn; i++) {
-		transcripts.push_back(n_node -> get_transcripts() -> at(i));
-		counts.push_back((int)(n_node -> get_transcript_expr(i)));
+	transcripts.reserve(cn + nn);
+	counts.reserve(cn + nn);
+	for (const ClusterNode *node : {c_node, n_node}) {
+		const int t_num = node -> get_transcript_num();
+		for (int i = 0; i < t_num; i++) {
+			const ExonSpan transcript = node -> get_transcript(i);
+			transcripts.emplace_back(transcript.begin(), transcript.end());
+			counts.push_back((int)(node -> get_transcript_expr(i)));
+		}
 	}
 	c_node -> clear_transcripts();
 
@@ -0,0 +1,231 @@
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+
+#include "NodePool.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Node Pool Methods */
+
+// Static Member Defintions
+std::vector<std::unique_ptr<NodePool::Deque>> NodePool::deques;
+NodePool::Deque NodePool::roots;
+std::vector<std::thread> NodePool::workers;
+std::atomic<int> NodePool::outside{0};
+std::atomic<int> NodePool::queued{0};
+std::mutex NodePool::sleep_lock;
+std::condition_variable NodePool::sleep_cv;
+bool NodePool::quit = false;
+int NodePool::pool_threads = 0;
+std::atomic<size_t> NodePool::tasks_run{0};
+std::atomic<size_t> NodePool::steals{0};
+
+// Calling thread's deque (-1 until it first needs one), and the start() it was given under
+static thread_local int slot = -1;
+static thread_local int slot_generation = -1;
+static int generation = 0;
+
+/////////////////////////////////////////////////////////////
+/* Pool Functions */
+
+void NodePool::start(const int &threads, const int &outside_threads) {
+	if (threads <= 0 || running()) { return; }
+	generation += 1;
+	pool_threads = threads;
+	quit = false;
+	outside = 0;
+	deques.clear();
+	for (int i = 0; i < threads + outside_threads + 1; i++) { deques.push_back(std::make_unique<Deque>()); }
+	for (int i = 0; i < threads; i++) { workers.emplace_back(&NodePool::worker, i); }
+}
+
+// Only call once every group has been waited on
+void NodePool::stop() {
+	if (!running()) { return; }
+	{
+		std::unique_lock<std::mutex> lock(sleep_lock);
+		quit = true;
+	}
+	sleep_cv.notify_all();
+	for (auto &t : workers) { t.join(); }
+	workers.clear();
+	deques.clear();
+}
+
+// Workers own the first deques; outside threads take the next free one as they first submit
+//	(past the count given to start, they share the last)
+int NodePool::home() {
+	if (slot_generation != generation) {
+		const int first_outside = workers.size();
+		const int last = deques.size() - 1;
+		slot = std::min(first_outside + outside++, last);
+		slot_generation = generation;
+	}
+	return slot;
+}
+
+// Own newest task, else the oldest task of another deque, else (if taking roots) the oldest root
+bool NodePool::take(const int &self, Task &task, const bool &take_roots) {
+	if (queued.load() == 0) { return false; }
+	const int n = deques.size();
+	for (int k = 0; k < n; k++) {
+		const int i = (self + k) % n;
+		Deque &d = *deques[i];
+		std::unique_lock<std::mutex> lock(d.mlock);
+		if (d.tasks.empty()) { continue; }
+		if (k == 0) {
+			task = std::move(d.tasks.back());
+			d.tasks.pop_back();
+		} else {
+			task = std::move(d.tasks.front());
+			d.tasks.pop_front();
+			steals += 1;
+		}
+		queued -= 1;
+		return true;
+	}
+	if (!take_roots) { return false; }
+	std::unique_lock<std::mutex> lock(roots.mlock);
+	if (roots.tasks.empty()) { return false; }
+	task = std::move(roots.tasks.front());
+	roots.tasks.pop_front();
+	queued -= 1;
+	return true;
+}
+
+// Newest task of the group on the calling thread's deque
+bool NodePool::take_own(Group &group, Task &task) {
+	Deque &d = *deques[home()];
+	std::unique_lock<std::mutex> lock(d.mlock);
+	for (auto it = d.tasks.rbegin(); it != d.tasks.rend(); ++it) {
+		if (it -> group != &group) { continue; }
+		task = std::move(*it);
+		d.tasks.erase(std::next(it).base());
+		queued -= 1;
+		return true;
+	}
+	return false;
+}
+
+// Run a task, then count it off its group (under the group's lock, so a waiter
+//	that sees the group done cannot free it before this is finished with it)
+void NodePool::run(Task &task) {
+	task.job();
+	tasks_run += 1;
+	Group &group = *task.group;
+	bool roots_done;
+	{
+		std::unique_lock<std::mutex> lock(group.mlock);
+		roots_done = (--group.pending == 0 && group.roots);
+		if (group.pending == 0) { group.cv.notify_all(); }
+	}
+	// A thread waiting on roots sleeps with the workers (see wait)
+	if (roots_done) {
+		{ std::unique_lock<std::mutex> lock(sleep_lock); }
+		sleep_cv.notify_all();
+	}
+}
+
+void NodePool::worker(const int i) {
+	slot = i;
+	slot_generation = generation;
+	Task task;
+	while (true) {
+		if (take(i, task, true)) {
+			run(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_lock);
+		sleep_cv.wait(lock, [] { return queued.load() > 0 || quit; });
+		if (quit && queued.load() == 0) { return; }
+	}
+}
+
+/////////////////////////////////////////////////////////////
+/* Task Functions */
+
+void NodePool::submit(Group &group, call job) {
+	if (!running()) {
+		job();
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(group.mlock);
+		group.pending += 1;
+	}
+	Deque &d = *deques[home()];
+	{
+		std::unique_lock<std::mutex> lock(d.mlock);
+		d.tasks.push_back(Task{std::move(job), &group});
+	}
+	{
+		std::unique_lock<std::mutex> lock(sleep_lock);
+		queued += 1;
+	}
+	sleep_cv.notify_one();
+}
+
+void NodePool::submit_root(Group &group, call job) {
+	if (!running()) {
+		job();
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(group.mlock);
+		group.pending += 1;
+		group.roots = true;
+	}
+	{
+		std::unique_lock<std::mutex> lock(roots.mlock);
+		roots.tasks.push_back(Task{std::move(job), &group});
+	}
+	{
+		std::unique_lock<std::mutex> lock(sleep_lock);
+		queued += 1;
+	}
+	sleep_cv.notify_one();
+}
+
+// Run queued tasks (this group's or any other's) until the group is done; once nothing
+//	is left to take, its last tasks are running elsewhere, so sleep until they finish.
+//	Waiting on roots, the thread is a worker until then: its roots' nodes are still to come.
+void NodePool::wait(Group &group) {
+	Task task;
+	bool roots;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(group.mlock);
+			if (group.pending == 0) { return; }
+			roots = group.roots;
+		}
+		if (running() && take(home(), task, roots)) {
+			run(task);
+			continue;
+		}
+		if (roots) {
+			std::unique_lock<std::mutex> lock(sleep_lock);
+			sleep_cv.wait(lock, [&] {
+				std::unique_lock<std::mutex> group_lock(group.mlock);
+				return queued.load() > 0 || group.pending == 0;
+			});
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(group.mlock);
+		group.cv.wait(lock, [&] { return group.pending == 0; });
+		return;
+	}
+}
+
+void NodePool::join(Group &group) {
+	Task task;
+	while (running() && take_own(group, task)) { run(task); }
+	std::unique_lock<std::mutex> lock(group.mlock);
+	group.cv.wait(lock, [&] { return group.pending == 0; });
+}
+
+void NodePool::print_stats(std::ostream &out) {
+	if (tasks_run == 0) { return; }
+	out << "//    Node Pool..........\n"
+	    << "//        workers:            " << pool_threads << "\n"
+	    << "//        tasks:              " << tasks_run << " (" << steals << " stolen)\n";
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "PointSpill.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Point Spill Methods */
+
+// Static Member Defintions
+size_t PointSpill::budget = 0;
+std::atomic<long long> PointSpill::resident{0};
+int PointSpill::fd = -1;
+std::once_flag PointSpill::open_flag;
+std::atomic<uint64_t> PointSpill::file_end{0};
+std::atomic<size_t> PointSpill::spills{0};
+std::atomic<size_t> PointSpill::reloads{0};
+std::atomic<long long> PointSpill::peak{0};
+
+/////////////////////////////////////////////////////////////
+/* Budget */
+
+void PointSpill::adjust(const long long &bytes) {
+	const long long now = (resident += bytes);
+	long long high = peak.load(std::memory_order_relaxed);
+	while (now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {}
+}
+
+/////////////////////////////////////////////////////////////
+/* File Functions */
+
+// $TMPDIR (or /tmp), unlinked straight away so nothing is left behind however the run ends
+void PointSpill::open() {
+
+	const char *tmp_dir = std::getenv("TMPDIR");
+	std::string path = std::string((tmp_dir != nullptr && *tmp_dir != '\0') ? tmp_dir : "/tmp") + "/impaqt-spill-XXXXXX";
+	std::vector<char> name(path.begin(), path.end());
+	name.push_back('\0');
+
+	fd = mkstemp(name.data());
+	if (fd < 0) {
+		std::cerr << "ERROR: Could not create spill file in " << path.substr(0, path.rfind('/')) << ": " << std::strerror(errno) << "\n";
+		throw std::runtime_error("ERROR: Could not create spill file. Set TMPDIR to a writable directory or raise --max-memory.");
+	}
+	unlink(name.data());
+}
+
+uint64_t PointSpill::reserve(const size_t &n) {
+	std::call_once(open_flag, PointSpill::open);
+	++spills;
+	return file_end.fetch_add(n);
+}
+
+void PointSpill::write_at(const uint64_t &offset, const void *data, const size_t &n) {
+	const char *p = (const char*)data;
+	size_t done = 0;
+	while (done < n) {
+		const ssize_t w = pwrite(fd, p + done, n - done, offset + done);
+		if (w < 0 && errno == EINTR) { continue; }
+		if (w <= 0) {
+			std::cerr << "ERROR: Could not write spill file: " << std::strerror(errno) << "\n";
+			throw std::runtime_error("ERROR: Could not write spill file. Check free space in TMPDIR.");
+		}
+		done += w;
+	}
+}
+
+void PointSpill::read_at(const uint64_t &offset, void *data, const size_t &n) {
+	char *p = (char*)data;
+	size_t done = 0;
+	while (done < n) {
+		const ssize_t r = pread(fd, p + done, n - done, offset + done);
+		if (r < 0 && errno == EINTR) { continue; }
+		if (r <= 0) {
+			std::cerr << "ERROR: Could not read spill file: " << std::strerror(errno) << "\n";
+			throw std::runtime_error("ERROR: Could not read back spilled points.");
+		}
+		done += r;
+	}
+}
+
+void PointSpill::close() {
+	if (fd >= 0) { ::close(fd); fd = -1; }
+}
+
+// Reloads well above spills: stores bounce between stages, the budget is too tight for the data
+void PointSpill::print_stats(std::ostream &out) {
+	if (!enabled()) { return; }
+	out << "//    Point Spill........\n"
+	    << "//        budget:             " << (budget >> 20) << " MB\n"
+	    << "//        peak settled:       " << (peak >> 20) << " MB\n"
+	    << "//        spilled:            " << spills << " nodes, " << (file_end >> 20) << " MB\n"
+	    << "//        reloaded:           " << reloads << " nodes\n";
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ReadAhead.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Read Ahead Methods */
+
+/////////////////////////////////////////////////////////////
+/* File Functions */
+
+bool ReadAhead::open(const std::string &bam_name, const std::string &bai_name) {
+
+	this -> close();
+	fd = ::open(bam_name.c_str(), O_RDONLY);
+	if (fd < 0) { return false; }
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+		this -> close();
+		return false;
+	}
+	file_size = info.st_size;
+
+	// No (or unreadable) BAI: whole-file hints only
+	if (bai_name.empty()) { return true; }
+	std::ifstream bai_file(bai_name, std::ios::binary);
+	if (!bai_file) { return true; }
+	const std::vector<unsigned char> bai((std::istreambuf_iterator<char>(bai_file)), std::istreambuf_iterator<char>());
+	if (!this -> parse_index(bai)) {
+		std::cerr << "// NOTICE: " << bai_name << " is not a BAI index; read-ahead hints cover the whole file.\n";
+		ranges.clear();
+	}
+	return true;
+}
+
+void ReadAhead::close() {
+	if (fd >= 0) { ::close(fd); }
+	fd = -1;
+	file_size = 0;
+	ranges.clear();
+	advised_all = false;
+}
+
+/*
+  BAI layout (SAM spec 5.2): magic "BAI\1", n_ref, then per reference
+  n_bin x {bin, n_chunk, n_chunk x {beg, end}} and n_intv x {ioffset}.
+  Offsets are virtual (compressed offset << 16 | offset in block).
+  Pseudo-bin 37450 holds the reference's own {beg, end} but is optional,
+  so the range is taken over every chunk.
+*/
+bool ReadAhead::parse_index(const std::vector<unsigned char> &bai) {
+
+	const unsigned char *p = bai.data();
+	const unsigned char *end = bai.data() + bai.size();
+
+	auto read_i32 = [&](int32_t &v) -> bool {
+		if (end - p < 4) { return false; }
+		std::memcpy(&v, p, 4); p += 4; return true;
+	};
+	auto read_u64 = [&](uint64_t &v) -> bool {
+		if (end - p < 8) { return false; }
+		std::memcpy(&v, p, 8); p += 8; return true;
+	};
+
+	if (bai.size() < 8 || std::memcmp(p, "BAI\1", 4) != 0) { return false; }
+	p += 4;
+
+	int32_t n_ref, n_bin, n_chunk, n_intv;
+	uint32_t bin;
+	uint64_t beg, stop;
+	if (!read_i32(n_ref) || n_ref < 0) { return false; }
+	ranges.resize(n_ref);
+
+	for (int32_t r = 0; r < n_ref; r++) {
+
+		ContigRange &range = ranges[r];
+		if (!read_i32(n_bin)) { return false; }
+
+		for (int32_t b = 0; b < n_bin; b++) {
+			if (end - p < 4) { return false; }
+			std::memcpy(&bin, p, 4); p += 4;
+			if (!read_i32(n_chunk)) { return false; }
+			for (int32_t c = 0; c < n_chunk; c++) {
+				if (!read_u64(beg) || !read_u64(stop)) { return false; }
+				if (bin == 37450) { continue; } // pseudo-bin: {beg, end} and mapped/unmapped counts
+				range.start = std::min(range.start, beg >> 16);
+				range.stop = std::max(range.stop, (stop >> 16) + 1);
+			}
+		}
+
+		if (!read_i32(n_intv)) { return false; }
+		range.windows.resize(n_intv);
+		for (int32_t i = 0; i < n_intv; i++) {
+			if (!read_u64(range.windows[i])) { return false; }
+			range.windows[i] >>= 16;
+		}
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////
+/* Read-Ahead Hints */
+
+void ReadAhead::advise(uint64_t start, uint64_t stop) const {
+	if (fd < 0 || start >= file_size) { return; }
+	stop = std::min<uint64_t>(stop + 65536, file_size);  // finish the last BGZF block (<= 64 kb)
+	posix_fadvise(fd, start, stop - start, POSIX_FADV_WILLNEED);
+}
+
+void ReadAhead::advise_contig(const int &contig_index, const int &t_start, const int &t_stop) const {
+
+	// No range for it (no BAI): the whole file instead (advised once for every contig)
+	if (contig_index < 0 || contig_index >= (int)ranges.size()) { this -> advise_all(); return; }
+
+	const ContigRange &range = ranges[contig_index];
+	if (range.start >= range.stop) { return; } // no reads
+
+	// Linear index: first block that can hold reads overlapping t_start
+	uint64_t start = range.start;
+	const size_t window = std::max(t_start, 0) >> 14;
+	if (window < range.windows.size() && range.windows[window] > start) { start = range.windows[window]; }
+
+	// A tile reads on past its nominal stop to the next read gap, so give it one more window
+	uint64_t stop = range.stop;
+	const size_t last = (t_stop < 0) ? range.windows.size() : ((size_t)t_stop >> 14) + 2;
+	for (size_t w = last; w < range.windows.size(); w++) {
+		if (range.windows[w] > start) { stop = std::min(stop, range.windows[w]); break; }
+	}
+
+	this -> advise(start, stop);
+}
+
+void ReadAhead::advise_all() const {
+	if (advised_all.exchange(true)) { return; }
+	this -> advise(0, file_size);
+}
@@ -9,7 +9,8 @@
 
 #include "global_args.h"
 #include "ArgParser.h"
-#include "ThreadQueue.h"
+#include "OrderedWriter.h"
+#include "NodePool.h"
 #include "impaqt.h"
 
 // Globals
@@ -18,15 +19,11 @@ ImpaqtArguments::GlobalArgs ImpaqtArguments::Args;
 // Static Member Defintions
 std::string Impaqt::alignment_file_name;
 std::string Impaqt::index_file_name;
+ReadAhead Impaqt::read_ahead;
 AnnotationList Impaqt::annotation;
 std::unordered_map<int, std::string> Impaqt::contig_map;
 std::unordered_map<int, int> Impaqt::contig_lengths;
 
-// Mutex and Conditinoal vars
-std::mutex main_mut;
-std::condition_variable main_cv;
-bool MAIN_THREAD = false;
-
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /* IMPAQT */
@@ -40,6 +37,14 @@ int run_impaqt(int argc, char const ** argv) {
     if (res == ParseStatus::Error) { return 1; }
     if (res == ParseStatus::Done) { return 0; }  // --help / --version printed
 
+    // Shared BGZF decompression pool (no-op unless built with htslib)
+    AlignmentReader::init_thread_pool(ImpaqtArguments::Args.bgzf_threads);
+    PointSpill::set_budget((size_t)ImpaqtArguments::Args.max_memory << 20);
+
+    // Contigs, nodes and chunks all run on one pool: -t minus one workers, plus this thread
+    const int proc = std::max(ImpaqtArguments::Args.threads, 1);
+    NodePool::start(proc - 1, 1);
+
     // Welcome!
     std::cerr << "//Impaqt\n";
     std::cerr << "//Parsing Input Files:\n";
@@ -51,6 +56,7 @@ int run_impaqt(int argc, char const ** argv) {
     processes.emplace_back(std::make_unique<Impaqt>(init_thread));
     processes[init_thread] -> open_alignment_file();
     processes[init_thread] -> set_chrom_order();
+    if (ImpaqtArguments::Args.readahead) { Impaqt::open_read_ahead(); }
 
     AnnotationList *annotation;
     if (ImpaqtArguments::Args.annotation_file != "") {
@@ -67,27 +73,7 @@ int run_impaqt(int argc, char const ** argv) {
         for (int i = 1; i < n; i++) { processes.emplace_back(std::make_unique<Impaqt>(i)); }
     }
 
-    // Launch Threads
-    std::cerr << "//Processing Data:\n";
-    std::cerr << "//    Contigs: " << n << "\n";
-    const int proc = std::max(ImpaqtArguments::Args.threads, 1);
-    {
-        int i = 0;
-        thread_queue call_queue(proc);
-        do {
-            while (i < n) {
-                call_queue.dispatch([&, i] {processes[i] -> launch();});
-                i++;
-            }
-        } while (!call_queue.finished()); // Wait for queue to be emptied
-    }
-    std::unique_lock<std::mutex> main_lock(main_mut);      // lock main thread
-    main_cv.wait(main_lock, [] {return MAIN_THREAD;});     // wait for thread_queue destructor to let go
-    main_lock.unlock();                                    // unlock thread
-
-
-    std::cerr << "//Writing Results:\n";       
-    std::cerr << "//    GTF File...........\n";
+    // Output (opened up front: contigs are written as soon as they and those before them finish)
     std::ofstream gtfFile;
     gtfFile.open(ImpaqtArguments::Args.gtf_output);
     gtfFile << "##description: transcripts identified by Impaqt\n"
@@ -99,8 +85,71 @@ int run_impaqt(int argc, char const ** argv) {
             << ", count_percentage: " << ImpaqtArguments::Args.count_percentage
             << ", epsilon: " << ImpaqtArguments::Args.epsilon << "\n";
 
-    // Write Transcripts
-    for (const auto &p : processes) { p -> write_gtf(gtfFile); }
+    long double total_assigned = 0.0;
+    long double total_unassigned = 0.0;
+    long double total_ambiguous = 0.0;
+    size_t total_multimapping = 0;
+    size_t total_low_quality = 0;
+    size_t total_reads = 0;
+    size_t total_transcripts = 0;
+
+    // Write a finished contig, add up its counts and drop its clusters (in contig order, see OrderedWriter)
+    OrderedWriter writer(n, [&](const int &i) {
+        processes[i] -> write_gtf(gtfFile);
+        if (!(processes[i] -> is_ignored())) {
+            total_assigned += processes[i] -> get_assigned_reads();
+            total_unassigned += processes[i] -> get_unassigned_reads();
+            total_ambiguous += processes[i] -> get_ambiguous_reads();
+        }
+        total_multimapping += processes[i] -> get_multimapped_reads();
+        total_low_quality += processes[i] -> get_low_quality_reads();
+        total_reads += processes[i] -> get_total_reads();
+        total_transcripts += processes[i] -> get_transcript_num();
+        processes[i] -> release_clusters();
+    });
+    for (auto &process : processes) { process -> set_output(&writer, &gtfFile); } // --windowed writes loci as they finish
+
+    // Launch Threads
+    std::cerr << "//Processing Data:\n";
+    std::cerr << "//    Contigs: " << n << "\n";
+    NodePool::Group contigs;
+    if (ImpaqtArguments::Args.stream) {
+        // One pass over the file: contigs are read here in order, the rest runs on the pool
+        AlignmentReader &stream_file = processes[init_thread] -> get_alignment_file();
+        stream_file.start_pipeline(ImpaqtArguments::Args.ring_size);
+        for (int i = 0; i < n; i++) {
+            if (ImpaqtArguments::Args.windowed) {
+                processes[i] -> stream_windows(stream_file);   // finished as they are read, nothing to queue
+                writer.complete(i);
+                continue;
+            }
+            processes[i] -> stream_clusters(stream_file);
+            NodePool::submit_root(contigs, [&, i] {processes[i] -> process_clusters(); writer.complete(i);});
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            const int tiles = processes[i] -> init_tiles();
+            if (tiles == 1) {
+                NodePool::submit_root(contigs, [&, i] {processes[i] -> launch(); writer.complete(i);});
+            } else {
+                for (int t = 0; t < tiles; t++) {
+                    NodePool::submit_root(contigs, [&, i, t] {if (processes[i] -> launch_tile(t)) { writer.complete(i); }});
+                }
+            }
+        }
+    }
+    NodePool::wait(contigs);                               // this thread works too until every contig is done
+    processes[init_thread] -> close_alignment_file();      // every reader closed, pool can go
+    NodePool::stop();
+    AlignmentReader::destroy_thread_pool();
+    Impaqt::close_read_ahead();
+    AlignmentReader::print_pipeline_stats(std::cerr);
+    PointSpill::print_stats(std::cerr);
+    NodePool::print_stats(std::cerr);
+
+
+    std::cerr << "//Writing Results:\n";       
+    std::cerr << "//    GTF File...........\n";
     gtfFile.close();
 
 
@@ -108,26 +157,6 @@ int run_impaqt(int argc, char const ** argv) {
         std::cerr << "//    Counts Data........\n";
         annotation -> print_gene_counts();
 
-        long double total_assigned = 0.0;
-        long double total_unassigned = 0.0;
-        long double total_ambiguous = 0.0;
-        size_t total_multimapping = 0;
-        size_t total_low_quality = 0;
-        size_t total_reads = 0;
-        size_t total_transcripts = 0;
-
-        for (int i = 0; i < n; i++) {
-            if (!(processes[i] -> is_ignored())) {
-                total_assigned += processes[i] -> get_assigned_reads();
-                total_unassigned += processes[i] -> get_unassigned_reads();
-                total_ambiguous += processes[i] -> get_ambiguous_reads();
-            }
-            total_multimapping += processes[i] -> get_multimapped_reads();
-            total_low_quality += processes[i] -> get_low_quality_reads();
-            total_reads += processes[i] -> get_total_reads();
-            total_transcripts += processes[i] -> get_transcript_num();
-        }
-
         std::cout << "//assigned\t" << std::fixed << std::setprecision(2) << total_assigned << "\n"
                   << "//unassigned\t" << std::fixed << std::setprecision(2) << total_unassigned << "\n"
                   << "//ambiguous\t" << std::fixed << std::setprecision(2) << total_ambiguous << "\n"
@@ -2,6 +2,8 @@
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <sys/stat.h>
 
 #include "global_args.h"
 
@@ -148,7 +150,48 @@ void print_transcripts(const std::vector<std::vector<int>> &transcripts) {
 }
 
 
+// Sort (key << 32 | payload) pairs by key, equal keys in payload order
+//	LSD radix over the key, 8 bits a pass. Node offsets rarely reach the top bytes of
+//	a 32-bit key, so a pass where every pair has the same byte is skipped (16-bit
+//	offsets sort in two). Small inputs just compare the packed pairs, same order.
+void radix_sort_pairs(std::vector<uint64_t> &pairs, std::vector<uint64_t> &tmp) {
+
+	const size_t n = pairs.size();
+	if (n < 64) {
+		std::sort(pairs.begin(), pairs.end());
+		return;
+	}
+
+	size_t counts[4][256] = {};
+	for (const uint64_t &p : pairs) {
+		for (int b = 0; b < 4; b++) { counts[b][(p >> (32 + 8 * b)) & 0xFF] += 1; }
+	}
+
+	tmp.resize(n);
+	for (int b = 0; b < 4; b++) {
+		const int shift = 32 + 8 * b;
+		if (counts[b][(pairs[0] >> shift) & 0xFF] == n) { continue; }
+
+		size_t offset = 0;
+		for (size_t &c : counts[b]) {
+			const size_t t_count = c;
+			c = offset;
+			offset += t_count;
+		}
+		for (const uint64_t &p : pairs) { tmp[counts[b][(p >> shift) & 0xFF]++] = p; }
+		pairs.swap(tmp);
+	}
+}
+
 // Check if file exists
 bool file_exists(const std::string& filename) {
 	return std::ifstream(filename).good();
+}
+
+// Uses stat so a FIFO is never opened (that would block on, or steal from, the writer)
+bool is_pipe(const std::string& filename) {
+	if (filename == "-") { return true; }
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0) { return false; }
+	return S_ISFIFO(info.st_mode) || S_ISCHR(info.st_mode);
 }
\ No newline at end of file
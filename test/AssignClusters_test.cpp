@@ -29,12 +29,13 @@ ImpaqtArguments::GlobalArgs ImpaqtArguments::Args = {"",          // bam
                                                     };
 
 
-// Build a gene on chr1 (+) with three disjoint exons:
+// Build a gene on chr1 (+, RefID 0) with three disjoint exons:
 //   [99,199], [399,499], [699,799]  (0-based, inclusive; GeneNode subtracts 1)
 static GeneNode make_three_exon_gene(const std::string &id) {
    GeneNode g(id, "chr1", "+", "100", "200");  // first exon -> [99,199]
    g.add_region("400", "500");                 // -> [399,499]
    g.add_region("700", "800");                 // -> [699,799]
+   g.set_contig_id(0);
    return g;
 }
 
@@ -104,8 +105,9 @@ TEST_F(AssignTest, ClosestGeneTraversal) {
    GeneNode a("a", "chr1", "+", "100", "200");   // stop = 199
    GeneNode b("b", "chr1", "+", "400", "500");   // stop = 499
    a.set_next(&b);  b.set_prev(&a);
+   a.set_contig_id(0);  b.set_contig_id(0);       // chr1 is RefID 0 (see AnnotationList::set_contig_ids)
 
-   ClusterNode clust(100, 0, 2500, 0, "chr1");
+   ClusterNode clust(100, 0, 2500, 0);
 
    EXPECT_EQ(get_closest_gene(50,  &a, &clust), &a);       // before a -> a
    EXPECT_EQ(get_closest_gene(300, &a, &clust), &b);       // past a -> b
@@ -113,6 +115,7 @@ TEST_F(AssignTest, ClosestGeneTraversal) {
 
    // A gene on a different contig terminates the search.
    GeneNode other("z", "chr2", "+", "400", "500");
+   other.set_contig_id(1);
    a.set_next(&other);  other.set_prev(&a);
    EXPECT_EQ(get_closest_gene(300, &a, &clust), nullptr);
 }
@@ -144,7 +147,7 @@ TEST_F(AssignTest, AssignReadsToGenesEndToEnd) {
    GeneNode g = make_three_exon_gene("gene1");
    g.set_next(nullptr);
 
-   ClusterNode node(100, 0, 2500, 0, "chr1");
+   ClusterNode node(100, 0, 2500, 0);
    node.add_alignment({120, 180}, {});  // read 0 -> inside exon 0  (assigned)
    node.add_alignment({420, 480}, {});  // read 1 -> inside exon 1  (assigned)
    node.add_alignment({250, 350}, {});  // read 2 -> in the gap     (unassigned)
@@ -9,6 +9,7 @@
 #include "gtest/gtest.h"
 #include "global_args.h"
 #include "impaqt.h"
+#include "OrderedWriter.h"
 
 
 // Globals
@@ -35,6 +36,7 @@ ImpaqtArguments::GlobalArgs ImpaqtArguments::Args = {"../test/data/test_negative
 // Static Member Defintions
 std::string Impaqt::alignment_file_name;
 std::string Impaqt::index_file_name;
+ReadAhead Impaqt::read_ahead;
 AnnotationList Impaqt::annotation;
 std::unordered_map<int, std::string> Impaqt::contig_map;
 std::unordered_map<int, int> Impaqt::contig_lengths;
@@ -73,11 +75,11 @@ TEST_F(impactTest, ConstructClustList) {
 TEST_F(impactTest, SpliceTest) {
 
    ClusterList *cluster_list = new ClusterList();
-   BamTools::BamReader SpliceFile;
-   BamTools::BamAlignment alignment;
+   AlignmentReader SpliceFile;
+   AlignmentRecord alignment;
 
    // Open alignment file 
-   if (!SpliceFile.Open("../test/data/SpliceTest.bam")) {
+   if (!SpliceFile.open("../test/data/SpliceTest.bam")) {
       std::cerr << "ERROR: Could not read alignment file: ../test/data/SpliceTest.bam\n";
       throw "ERROR: Make sure alignment file exists.";
    }
@@ -87,7 +89,7 @@ TEST_F(impactTest, SpliceTest) {
    std::vector<int> positions, junctions;
    std::vector<int> five_vec, three_vec;
 
-   while (SpliceFile.GetNextAlignment(alignment)) {
+   while (SpliceFile.get_next_alignment(alignment)) {
 
       positions.clear();
       cluster_list -> calculate_splice(alignment, positions, junctions);
@@ -126,9 +128,37 @@ TEST_F(impactTest, BasicCollapse) {
    ASSERT_EQ(test_process -> get_clusters() -> string_clusters(1), answer);
 };
 
-// Test 4: regression for the delete_list() null-head crash.
-// A list with no reads on a strand leaves that head null; tearing it down must
-// not dereference a null node. Pre-fix this segfaulted in delete_list().
+// Test 4: tiles cut at wide read gaps stitch back into the whole-contig list.
+// Nominal boundaries at 20000 and 35000 each snap forward to the next wide read gap.
+TEST_F(impactTest, TiledCollapse) {
+
+   const std::vector<int> bounds = {-1, 20000, 35000, -1};
+   ClusterList stitched(0, "chr1", 1000000);
+
+   for (int t = 0; t < 3; t++) {
+
+      AlignmentReader tile_file;
+      AlignmentRecord alignment;
+      ASSERT_TRUE(tile_file.open(ImpaqtArguments::Args.alignment_file));
+      ASSERT_TRUE(tile_file.open_index(ImpaqtArguments::Args.index_file));
+      ASSERT_TRUE(tile_file.jump(0, std::max(bounds[t], 0)));
+
+      ClusterList tile(0, "chr1", 1000000);
+      tile.set_tile(bounds[t], bounds[t + 1]);
+      tile.create_clusters(tile_file, alignment);
+      tile.collapse_clusters(0);
+      tile.collapse_clusters(1);
+      stitched.append_list(&tile);
+   }
+
+   std::string answer = read_test_file("../test/data/test_collapse.txt");
+   ASSERT_EQ(stitched.string_clusters(1), answer);
+   ASSERT_EQ(stitched.get_total_reads(), test_process -> get_clusters() -> get_total_reads());
+};
+
+// Test 5: regression for the old delete_list() null-head crash.
+// A list with no reads on a strand has an empty arena (null head); tearing it
+// down must not dereference a null node.
 TEST_F(impactTest, DestroyEmptyList) {
    { ClusterList empty_list(0, "chr1", 1000); }  // both heads null; destructs here
    { ClusterList default_list; }                 // default-constructed, also empty
@@ -136,3 +166,295 @@ TEST_F(impactTest, DestroyEmptyList) {
 };
 
 
+
+// Test 6: add_splice writes the same point pairs as calculate_splice, straight into a node
+// (identical reads fold into their first copy, so compare as sorted lines)
+TEST_F(impactTest, SpliceIntoNode) {
+
+   ClusterList cluster_list;
+   ClusterNode node(0, 0, 1000, 0);
+   AlignmentReader SpliceFile;
+   AlignmentRecord alignment;
+   ASSERT_TRUE(SpliceFile.open("../test/data/SpliceTest.bam"));
+
+   int read_count = 0;
+   while (SpliceFile.get_next_alignment(alignment)) {
+      cluster_list.add_splice(&node, alignment);
+      ++read_count;
+   }
+
+   std::vector<std::string> answer, result;
+   std::istringstream answer_file(read_test_file("../test/data/SpliceTest.result"));
+   for (std::string line; std::getline(answer_file, line); ) { answer.push_back(line); }
+
+   const PointStore &points = node.get_points();
+   for (size_t r = 0; r < points.reads(); r++) {
+      for (int w = 0; w < points.read_weight(r); w++) {
+         for (size_t k = points.read_begin(r); k < points.read_end(r); k++) {
+            result.push_back(std::to_string(points.five(k)) + "," + std::to_string(points.three(k)));
+         }
+      }
+   }
+
+   std::sort(answer.begin(), answer.end());
+   std::sort(result.begin(), result.end());
+   ASSERT_EQ(result, answer);
+   ASSERT_EQ(node.get_read_count(), (size_t)read_count);
+   ASSERT_LT(node.get_vec_count(), answer.size()); // SpliceTest.bam has repeated reads
+};
+
+// Test 7: clusters built through the decoder ring match the inline reader (tiny ring, so both sides wait)
+TEST_F(impactTest, PipelinedCluster) {
+
+   AlignmentReader ring_file;
+   AlignmentRecord alignment;
+   ASSERT_TRUE(ring_file.open(ImpaqtArguments::Args.alignment_file));
+   ASSERT_TRUE(ring_file.open_index(ImpaqtArguments::Args.index_file));
+   ASSERT_TRUE(ring_file.jump(0));
+   ring_file.start_pipeline(2, 0);
+
+   ClusterList ring_list(0, "chr1", 1000000);
+   ring_list.create_clusters(ring_file, alignment);
+   ring_file.close();
+
+   std::string answer = read_test_file("../test/data/test_cluster.txt");
+   ASSERT_EQ(ring_list.string_clusters(1), answer);
+   ASSERT_EQ(ring_list.get_total_reads(), test_process -> get_clusters() -> get_total_reads());
+};
+
+// Test 8: after collapsing (and stitching tiles), the links walk the arena slot by slot both ways
+TEST_F(impactTest, ArenaLinks) {
+
+   ClusterList *cluster_list = test_process -> get_clusters();
+   for (int t_strand = 0; t_strand < 2; t_strand++) {
+
+      ClusterNode *head = cluster_list -> get_head(t_strand);
+      ClusterNode *tail = cluster_list -> get_tail(t_strand);
+      if (head == nullptr) { ASSERT_EQ(tail, nullptr); continue; } // test.bam: reverse strand only
+      ASSERT_EQ(head -> get_prev(), nullptr);
+      ASSERT_EQ(tail -> get_next(), nullptr);
+
+      int nodes = 1;
+      for (ClusterNode *node = head; node != tail; node = node -> get_next()) {
+         ASSERT_EQ(node -> get_next(), node + 1);
+         ASSERT_EQ(node -> get_next() -> get_prev(), node);
+         ASSERT_GT(node -> get_next() -> get_start(), node -> get_stop());
+         ++nodes;
+      }
+      ASSERT_EQ(tail - head + 1, nodes);
+   }
+   ASSERT_NE(cluster_list -> get_head(1), nullptr);
+};
+
+// Test 9: points stay 16-bit offsets until one outgrows it, then widen without moving
+TEST_F(impactTest, PointOffsets) {
+
+   ClusterNode node(1000000, 0, 0, 0);
+   node.add_block(1000000, 1000100);
+   node.close_read();
+   ASSERT_FALSE(node.get_points().is_wide());
+
+   node.add_block(1000000, 1000100);
+   node.close_read();
+   node.add_block(1000050, 1070000);
+   node.close_read();
+   ASSERT_TRUE(node.get_points().is_wide());
+
+   // Second read folded into the first: 2 stored reads, 3 counted
+   const PointStore &points = node.get_points();
+   ASSERT_EQ(points.reads(), (size_t)2);
+   ASSERT_EQ(node.get_read_count(), (size_t)3);
+   ASSERT_EQ(points.read_weight(0), 2);
+   ASSERT_EQ(node.get_five(0), 1000000);
+   ASSERT_EQ(node.get_three(1), 1070000);
+   ASSERT_EQ(node.get_weight(1), 1);
+};
+
+// Test 10: junctions are kept once each, counted per read, and merged when nodes are
+TEST_F(impactTest, JunctionCounts) {
+
+   ClusterNode node(1000, 0, 0, 0);
+   ClusterNode next(3000, 0, 0, 0);
+   for (const int j : {1500, 1200, 1500, 1500, 1200}) { node.add_junction(j); }
+   for (const int j : {1500, 3500}) { next.add_junction(j); }
+
+   const JunctionIndex &junctions = node.get_junctions();
+   ASSERT_EQ(junctions.size(), (size_t)2);
+   ASSERT_EQ(junctions.position(0), 1200);
+   ASSERT_EQ(junctions.count_at(1500), (uint32_t)3);
+   ASSERT_TRUE(node.contains_junction(1100, 1200));
+   ASSERT_FALSE(node.contains_junction(1201, 1499));
+
+   node.absorb(next);
+   ASSERT_EQ(junctions.size(), (size_t)3);
+   ASSERT_EQ(junctions.count_at(1500), (uint32_t)4);
+   ASSERT_EQ(junctions.count_at(3500), (uint32_t)1);
+   ASSERT_TRUE(next.get_junctions().empty());
+};
+
+// Test 11: past --max-memory a settled node's points go to the spill file and come back intact
+TEST_F(impactTest, PointSpillRoundTrip) {
+
+   ClusterNode node(1000000, 0, 0, 0);
+   node.add_block(1000000, 1000100);
+   node.close_read();
+   node.add_block(1000000, 1000100);
+   node.close_read();
+   node.add_block(1000050, 1070000);
+   node.close_read();
+
+   PointSpill::set_budget(1);
+   node.settle_points();
+   ASSERT_TRUE(node.get_points().is_spilled());
+   ASSERT_EQ(node.get_points().reads(), (size_t)0);
+
+   node.load_points();
+   PointSpill::set_budget(0);
+   const PointStore &points = node.get_points();
+   ASSERT_FALSE(points.is_spilled());
+   ASSERT_TRUE(points.is_wide());
+   ASSERT_EQ(points.reads(), (size_t)2);
+   ASSERT_EQ(points.read_weight(0), 2);
+   ASSERT_EQ(node.get_five(1), 1000050);
+   ASSERT_EQ(node.get_three(1), 1070000);
+};
+
+// Test 12: windowed batches stop at every wide read gap, and stitch back into the whole-contig list
+TEST_F(impactTest, WindowedBatches) {
+
+   AlignmentReader window_file;
+   AlignmentRecord alignment;
+   ASSERT_TRUE(window_file.open(ImpaqtArguments::Args.alignment_file));
+   ASSERT_TRUE(window_file.open_index(ImpaqtArguments::Args.index_file));
+   ASSERT_TRUE(window_file.jump(0));
+
+   ClusterList stitched(0, "chr1", 1000000);
+   int batches = 0;
+   int last_cut = -1;
+   while (true) {
+      ClusterList batch(0, "chr1", 1000000);
+      batch.set_windowed();
+      batch.create_clusters(window_file, alignment);
+      batch.collapse_clusters(0);
+      batch.collapse_clusters(1);
+      stitched.append_list(&batch);
+      ++batches;
+
+      const int cut = batch.get_cut();
+      if (cut == -1) { break; }
+      ASSERT_GT(cut, last_cut);
+      ClusterNode *tail = stitched.get_tail(1);
+      if (tail != nullptr) { ASSERT_GT(cut, tail -> get_stop()); }
+      last_cut = cut;
+   }
+
+   std::string answer = read_test_file("../test/data/test_collapse.txt");
+   ASSERT_GT(batches, 1);
+   ASSERT_EQ(stitched.string_clusters(1), answer);
+   ASSERT_EQ(stitched.get_total_reads(), test_process -> get_clusters() -> get_total_reads());
+};
+
+// Test 13: read-ahead ranges come from the BAI's chunks; anything else is not taken for one
+TEST_F(impactTest, ReadAheadIndexRanges) {
+
+   ReadAhead read_ahead;
+   ASSERT_TRUE(read_ahead.open(ImpaqtArguments::Args.alignment_file, ImpaqtArguments::Args.index_file));
+   ASSERT_EQ(read_ahead.indexed_contigs(), (size_t)1);
+   ASSERT_EQ(read_ahead.contig_start(0), (uint64_t)192);    // first BGZF block after the header
+   ASSERT_EQ(read_ahead.contig_stop(0), (uint64_t)6326);    // past the start of the last block with reads
+   read_ahead.advise_contig(0, 1000, 2000);
+
+   ASSERT_TRUE(read_ahead.open(ImpaqtArguments::Args.alignment_file, "../test/data/test_negative.bam.csi"));
+   ASSERT_TRUE(read_ahead.is_open());
+   ASSERT_EQ(read_ahead.indexed_contigs(), (size_t)0);
+   read_ahead.close();
+   ASSERT_FALSE(read_ahead.is_open());
+};
+
+// Test 14: contigs completed out of order are flushed in contig order, by one thread at a time
+TEST_F(impactTest, OrderedWriterOrder) {
+
+   std::vector<int> flushed;
+   OrderedWriter writer(6, [&](const int &i) { flushed.push_back(i); });
+   const std::vector<int> order = {3, 1, 0, 5, 2, 4};
+   const std::vector<int> written = {0, 0, 2, 2, 4, 6};
+   for (size_t k = 0; k < order.size(); k++) {
+      writer.complete(order[k]);
+      ASSERT_EQ(writer.written(), written[k]);
+   }
+   ASSERT_EQ(flushed, std::vector<int>({0, 1, 2, 3, 4, 5}));
+
+   // Threads completing at once: a contig finishing while another thread writes is left to that writer
+   const int n = 400;
+   std::vector<int> t_flushed;
+   std::atomic<int> writers{0};
+   std::atomic<bool> overlapped{false};
+   OrderedWriter t_writer(n, [&](const int &i) {
+      if (++writers != 1) { overlapped = true; }
+      t_flushed.push_back(i);
+      std::this_thread::yield();
+      --writers;
+   });
+   std::vector<std::thread> threads;
+   for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&, t] { for (int i = n - 1 - t; i >= 0; i -= 4) { t_writer.complete(i); } });
+   }
+   for (auto &thread : threads) { thread.join(); }
+   ASSERT_FALSE(overlapped);
+   ASSERT_EQ(t_writer.written(), n);
+   ASSERT_EQ((int)t_flushed.size(), n);
+   for (int i = 0; i < n; i++) { ASSERT_EQ(t_flushed[i], i); }
+};
+
+// Test 15: --windowed writes each locus as it finishes, and ends with the same GTF and counts as the whole contig
+TEST_F(impactTest, WindowedMatchesWhole) {
+
+   test_process -> add_annotation();
+
+   Impaqt whole(0);
+   whole.launch();
+   std::ostringstream whole_gtf;
+   whole.write_gtf(whole_gtf);
+
+   ImpaqtArguments::Args.windowed = true;
+   Impaqt windowed(0);
+   std::ostringstream windowed_gtf;
+   OrderedWriter writer(1, [&](const int &i) { windowed.write_gtf(windowed_gtf); });
+   windowed.set_output(&writer, &windowed_gtf);
+   windowed.launch();
+   ImpaqtArguments::Args.windowed = false;
+
+   // Contig 0 has nothing before it, so its loci are out before it completes
+   ASSERT_NE(whole_gtf.str(), "");
+   ASSERT_EQ(windowed_gtf.str(), whole_gtf.str());
+   writer.complete(0);
+   ASSERT_EQ(windowed_gtf.str(), whole_gtf.str());
+
+   ASSERT_EQ(windowed.get_assigned_reads(), whole.get_assigned_reads());
+   ASSERT_EQ(windowed.get_unassigned_reads(), whole.get_unassigned_reads());
+   ASSERT_EQ(windowed.get_ambiguous_reads(), whole.get_ambiguous_reads());
+   ASSERT_EQ(windowed.get_multimapped_reads(), whole.get_multimapped_reads());
+   ASSERT_EQ(windowed.get_low_quality_reads(), whole.get_low_quality_reads());
+   ASSERT_EQ(windowed.get_total_reads(), whole.get_total_reads());
+   ASSERT_EQ(windowed.get_transcript_num(), whole.get_transcript_num());
+};
+
+// Test 16: in a run deeper than the unsorted tail, every duplicate still folds into its first copy
+TEST_F(impactTest, DeepRunFolding) {
+
+   ClusterNode node(1000, 0, 0, 0);
+   for (int copy = 0; copy < 3; copy++) {
+      for (int end = 0; end < 200; end++) { node.add_alignment({1000, 1100 + end}, {}); }
+   }
+   node.add_alignment({1001, 1100}, {});
+   node.add_alignment({1001, 1100}, {});
+
+   const PointStore &points = node.get_points();
+   ASSERT_EQ(points.reads(), (size_t)201);
+   ASSERT_EQ(node.get_read_count(), (size_t)602);
+   for (size_t r = 0; r < 200; r++) {
+      ASSERT_EQ(points.read_weight(r), 3);
+      ASSERT_EQ(node.get_three(r), 1100 + (int)r);
+   }
+   ASSERT_EQ(points.read_weight(200), 2);
+};
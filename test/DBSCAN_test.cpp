@@ -1,14 +1,20 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <thread>
+#include <atomic>
 #include <memory>
 #include <condition_variable>
 #include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <random>
 
 #include "gtest/gtest.h"
 #include "global_args.h"
 #include "impaqt.h"
+#include "NodePool.h"
 
 // Globals
 ImpaqtArguments::GlobalArgs ImpaqtArguments::Args = {"../test/data/dbscan_test.bam",      // bam
@@ -34,6 +40,7 @@ ImpaqtArguments::GlobalArgs ImpaqtArguments::Args = {"../test/data/dbscan_test.b
 // Static Member Defintions
 std::string Impaqt::alignment_file_name;
 std::string Impaqt::index_file_name;
+ReadAhead Impaqt::read_ahead;
 AnnotationList Impaqt::annotation;
 std::unordered_map<int, std::string> Impaqt::contig_map;
 std::unordered_map<int, int> Impaqt::contig_lengths;
@@ -91,14 +98,18 @@ TEST_F(impactTest, DBSCAN) {
    points = node -> get_vec_count();
    min_counts = std::max((int)((float)expr * (((float)ImpaqtArguments::Args.count_percentage / 100.0))), 10);
 
-   node -> point_sort_vectors();
-
    assign_vec_5 = dbscan(node, points, min_counts, regions_5, true);
    assign_vec_3 = dbscan(node, points, min_counts, regions_3, false);
 
+   // Points stay in read order; report them in 5' order
+   std::vector<int> order(points);
+   std::iota(order.begin(), order.end(), 0);
+   std::sort(order.begin(), order.end(), [&](int i, int j) { return node -> get_five(i) < node -> get_five(j); });
+
+   // One entry per read: identical reads are folded into one weighted point
    std::string result = "";
-   for (const auto &p : assign_vec_5) { result += std::to_string(p); }
-   for (const auto &p : assign_vec_3) { result += std::to_string(p); }
+   for (const int i : order) { for (int w = 0; w < node -> get_weight(i); w++) { result += std::to_string(assign_vec_5[i]); } }
+   for (const int i : order) { for (int w = 0; w < node -> get_weight(i); w++) { result += std::to_string(assign_vec_3[i]); } }
    result += "\n";
 
    // Generating the answer so I don't have to store this string;
@@ -134,6 +145,14 @@ TEST_F(impactTest, OverlapTranscripts) {
    }
 
    ASSERT_EQ(result, "4959707,4959824,4960962,4961094,4962137,4962291,");
+
+   // Reported into the contig's exon pool, unassigned until assign_to_genes
+   ASSERT_EQ(node -> get_transcript_num(), transcripts.size());
+   const ExonSpan reported = node -> get_transcript(0);
+   ASSERT_TRUE(std::equal(reported.begin(), reported.end(), transcripts[0].begin(), transcripts[0].end()));
+   ASSERT_EQ(node -> get_transcript_assignment(0), "Unassigned");
+   node -> assign_ambiguous(0);
+   ASSERT_EQ(node -> get_transcript_assignment(0), "Ambiguous");
 };
 
 // Test 3: regression for the >=10 cluster-index path bug.
@@ -181,4 +200,164 @@ TEST_F(impactTest, LargeClusterIndexPaths) {
       for (const auto &pos : p) { result += std::to_string(pos) + ","; }
    }
    ASSERT_EQ(result, "1000,1100,5000,5100,1000,1100,8000,8100,");
-};
\ No newline at end of file
+};
+
+// Test 4: the linear kernel reproduces the scan kernel (assignments and regions) on
+// Test 0's node and on random nodes: folded duplicates, peaks, noise, and loci
+// wide enough for 32-bit offsets.
+TEST_F(impactTest, LinearKernelMatchesScan) {
+
+   std::mt19937 rng(21);
+   const int epsilon = ImpaqtArguments::Args.epsilon;
+   auto both_kernels = [&](ClusterNode *n, const int &n_points, const int &n_min, const bool &five) {
+      std::map<int, std::vector<int>> scan_regions, linear_regions;
+      ImpaqtArguments::Args.dbscan_kernel = "scan";
+      const std::vector<int> scan_assign = dbscan(n, n_points, n_min, scan_regions, five);
+      ImpaqtArguments::Args.dbscan_kernel = "linear";
+      const std::vector<int> linear_assign = dbscan(n, n_points, n_min, linear_regions, five);
+      ASSERT_EQ(linear_assign, scan_assign);
+      ASSERT_EQ(linear_regions, scan_regions);
+   };
+
+   both_kernels(node, node -> get_vec_count(), 10, true);
+   both_kernels(node, node -> get_vec_count(), 10, false);
+
+   for (int trial = 0; trial < 300; trial++) {
+      const int locus = (trial % 10 == 0) ? 200000 : 5000;
+      const int reads = std::uniform_int_distribution<int>(1, 600)(rng);
+      const int peaks = std::uniform_int_distribution<int>(1, 8)(rng);
+      ImpaqtArguments::Args.epsilon = std::uniform_int_distribution<int>(0, 200)(rng);
+      std::uniform_int_distribution<int> anywhere(0, locus);
+      std::uniform_int_distribution<int> peak_at(0, peaks - 1);
+      std::normal_distribution<double> spread(0.0, 15.0);
+
+      ClusterNode random_node(1000, 0, locus, 0);
+      for (int r = 0; r < reads; r++) {
+         const bool noise = (r % 4 == 0);
+         const int center = (peak_at(rng) + 1) * locus / (peaks + 1);
+         const int five = 1000 + (noise ? anywhere(rng) : std::clamp(center + (int)spread(rng), 0, locus));
+         const int three = 1000 + (noise ? anywhere(rng) : std::clamp(center + locus / 10 + (int)spread(rng), 0, locus));
+         random_node.add_alignment({std::min(five, three), std::max(five, three)}, {});
+      }
+      const int n_points = random_node.get_vec_count();
+      const int n_min = std::max(reads * std::uniform_int_distribution<int>(1, 10)(rng) / 100, 1);
+      both_kernels(&random_node, n_points, n_min, true);
+      both_kernels(&random_node, n_points, n_min, false);
+   }
+   ImpaqtArguments::Args.epsilon = epsilon;
+};
+
+// Test 5: a node split into chunks (NodePool tasks) gives the single-thread clusters,
+// including runs of equal offsets and clusters that straddle chunk boundaries.
+TEST_F(impactTest, ParallelLinearKernel) {
+
+   std::mt19937 rng(23);
+   const int threads = ImpaqtArguments::Args.threads;
+   const int epsilon = ImpaqtArguments::Args.epsilon;
+   set_dbscan_parallel_points(16);
+   NodePool::start(3, 1);
+
+   for (int trial = 0; trial < 100; trial++) {
+      const int locus = (trial % 10 == 0) ? 200000 : 3000;
+      const int reads = std::uniform_int_distribution<int>(1, 3000)(rng);
+      ImpaqtArguments::Args.epsilon = std::uniform_int_distribution<int>(0, 120)(rng);
+      std::uniform_int_distribution<int> anywhere(0, locus);
+      std::normal_distribution<double> spread(0.0, 20.0);
+
+      ClusterNode random_node(1000, 0, locus, 0);
+      for (int r = 0; r < reads; r++) {
+         const int center = (r % 3 + 1) * locus / 4;
+         const int five = 1000 + ((r % 5 == 0) ? anywhere(rng) : std::clamp(center + (int)spread(rng), 0, locus));
+         random_node.add_alignment({five, five + 50}, {});
+      }
+      const int n_points = random_node.get_vec_count();
+      const int n_min = std::max(reads * std::uniform_int_distribution<int>(1, 10)(rng) / 100, 1);
+
+      std::map<int, std::vector<int>> serial_regions, parallel_regions;
+      ImpaqtArguments::Args.threads = 1;
+      const std::vector<int> serial_assign = dbscan(&random_node, n_points, n_min, serial_regions, true);
+      ImpaqtArguments::Args.threads = 1 + trial % 6;
+      const std::vector<int> parallel_assign = dbscan(&random_node, n_points, n_min, parallel_regions, true);
+      ASSERT_EQ(parallel_assign, serial_assign);
+      ASSERT_EQ(parallel_regions, serial_regions);
+   }
+
+   NodePool::stop();
+   set_dbscan_parallel_points(1 << 17);
+   ImpaqtArguments::Args.threads = threads;
+   ImpaqtArguments::Args.epsilon = epsilon;
+};
+
+// Test 6: node tasks on the work-stealing pool give the transcripts found inline, groups
+// submitted and waited on from several threads at once each see all their tasks run, and
+// roots (contig jobs) waiting on their own tasks all finish while this thread waits on them.
+TEST_F(impactTest, NodePoolTasks) {
+
+   auto find_gtf = [](const int &workers) {
+      NodePool::start(workers, 1);
+      Impaqt process(0);
+      process.open_alignment_file();
+      process.set_chrom_order();
+      process.create_clusters();
+      process.collapse_clusters();
+      process.find_transcripts();
+      NodePool::stop();
+      std::ostringstream gtf;
+      process.get_clusters() -> write_clusters_as_GTF(gtf);
+      return gtf.str();
+   };
+   const std::string inline_gtf = find_gtf(0);
+   ASSERT_FALSE(inline_gtf.empty());
+   ASSERT_EQ(find_gtf(3), inline_gtf);
+
+   NodePool::start(3, 4);
+   std::vector<std::thread> submitters;
+   std::vector<std::vector<int>> done(4, std::vector<int>(500, 0));
+   for (int s = 0; s < 4; s++) {
+      submitters.emplace_back([&done, s] {
+         for (int round = 0; round < 10; round++) {
+            NodePool::Group group;
+            for (int t = 0; t < 50; t++) { NodePool::submit(group, [&done, s, round, t] { done[s][round * 50 + t] += 1; }); }
+            NodePool::wait(group);
+         }
+      });
+   }
+   for (auto &t : submitters) { t.join(); }
+   NodePool::stop();
+   for (const auto &d : done) { ASSERT_EQ(d, std::vector<int>(500, 1)); }
+
+   NodePool::start(3, 1);
+   std::vector<int> root_done(20, 0);
+   NodePool::Group roots;
+   for (int r = 0; r < 20; r++) {
+      NodePool::submit_root(roots, [&root_done, r] {
+         std::atomic<int> ran{0};
+         NodePool::Group nodes;
+         for (int t = 0; t < 30; t++) { NodePool::submit(nodes, [&ran] { ran += 1; }); }
+         NodePool::wait(nodes);
+         root_done[r] = ran;
+      });
+   }
+   NodePool::wait(roots);
+   NodePool::stop();
+   ASSERT_EQ(root_done, std::vector<int>(20, 30));
+};
+
+// Test 7: radix_sort_pairs orders packed (offset, point) pairs as a comparison sort of the
+// pairs would: by offset, equal offsets in point order (16- and 32-bit offsets, short inputs).
+TEST_F(impactTest, RadixSortPairs) {
+
+   std::mt19937 rng(25);
+   std::vector<uint64_t> pairs, expected, tmp;
+   for (const int n : {0, 1, 63, 64, 1000, 100000}) {
+      for (const uint32_t top : {50u, 0xFFFFu, 0xFFFFFFFFu}) {
+         std::uniform_int_distribution<uint32_t> offset(0, top);
+         pairs.resize(n);
+         for (int i = 0; i < n; i++) { pairs[i] = ((uint64_t)offset(rng) << 32) | (uint32_t)i; }
+         expected = pairs;
+         std::sort(expected.begin(), expected.end());
+         radix_sort_pairs(pairs, tmp);
+         ASSERT_EQ(pairs, expected);
+      }
+   }
+};